@@ -0,0 +1,67 @@
+// Microbenchmark of FactWriter::writeFact. Writes synthetic facts of all
+// predicates, round-robin, to uncompressed files, and reports facts written
+// per second.
+//
+// Usage: factwriter-bench [FACTS [OUTPUT-DIR]]
+
+#include <boost/filesystem.hpp>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Compression.hpp"
+#include "FactWriter.hpp"
+#include "PredicateGroups.hpp"
+
+auto main(int argc, char *argv[]) -> int {
+  namespace fs = boost::filesystem;
+  using cclyzer::Compression;
+  using cclyzer::FactWriter;
+  using cclyzer::predicates::predicates_reg;
+
+  constexpr std::size_t DEFAULT_FACTS = 10000000;
+  constexpr std::size_t REFMODES = 1024;
+
+  const std::size_t facts = argc > 1 ? std::stoul(argv[1]) : DEFAULT_FACTS;
+  const bool temporary = argc <= 2;
+  const fs::path outdir =
+      temporary ? fs::temp_directory_path() / fs::unique_path() : argv[2];
+
+  const std::vector<const cclyzer::Predicate *> preds(
+      predicates_reg.begin(), predicates_reg.end());
+
+  // Refmodes of roughly the length of those of instructions
+  std::vector<std::string> refmodes;
+  for (std::size_t i = 0; i < REFMODES; i++) {
+    refmodes.push_back("<bench.c>:main:[" + std::to_string(i) + "]");
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  {
+    // Keep all files open, so that only the writes themselves are timed
+    FactWriter writer(
+        predicates_reg,
+        outdir,
+        "\t",
+        Compression::NONE,
+        cclyzer::DEFAULT_COMPRESSION_LEVEL,
+        preds.size());
+    for (std::size_t i = 0; i < facts; i++) {
+      writer.writeFact(
+          *preds[i % preds.size()], refmodes[i % refmodes.size()], i);
+    }
+    writer.close();
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  std::cout << facts << " facts in " << elapsed.count() << " s: "
+            << static_cast<double>(facts) / elapsed.count() << " facts/s\n";
+
+  if (temporary) {
+    fs::remove_all(outdir);
+  }
+  return 0;
+}
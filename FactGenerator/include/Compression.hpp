@@ -0,0 +1,80 @@
+#ifndef COMPRESSION_HPP__
+#define COMPRESSION_HPP__
+
+#include <iostream>
+#include <string>
+
+namespace cclyzer {
+
+// Codecs for the CSV fact files. Soufflé can only read uncompressed and
+// gzip-compressed facts; zstd is meant for archiving fact sets.
+enum class Compression { NONE, GZIP, ZSTD };
+
+constexpr char const* NONE_COMPRESSION_STRING = "none";
+constexpr char const* GZIP_COMPRESSION_STRING = "gzip";
+constexpr char const* ZSTD_COMPRESSION_STRING = "zstd";
+
+// Let the codec pick its default compression level
+constexpr int DEFAULT_COMPRESSION_LEVEL = -1;
+
+// Levels of gzip, besides the default
+constexpr int MIN_GZIP_COMPRESSION_LEVEL = 0;
+constexpr int MAX_GZIP_COMPRESSION_LEVEL = 9;
+
+// Levels of zstd (ZSTD_minCLevel() and ZSTD_maxCLevel()), where negative levels
+// trade ratio for speed, and 0 is zstd's own default
+constexpr int MIN_ZSTD_COMPRESSION_LEVEL = -(1 << 17);
+constexpr int MAX_ZSTD_COMPRESSION_LEVEL = 22;
+
+// Whether the codec accepts the given compression level. Uncompressed files
+// ignore the level.
+constexpr auto valid_compression_level(Compression compression, int level)
+    -> bool {
+  switch (compression) {
+    case Compression::NONE:
+      return true;
+    case Compression::GZIP:
+      return level == DEFAULT_COMPRESSION_LEVEL ||
+             (level >= MIN_GZIP_COMPRESSION_LEVEL &&
+              level <= MAX_GZIP_COMPRESSION_LEVEL);
+    case Compression::ZSTD:
+      return level >= MIN_ZSTD_COMPRESSION_LEVEL &&
+             level <= MAX_ZSTD_COMPRESSION_LEVEL;
+  }
+  return false;
+}
+
+// Description of the levels the codec accepts, for usage errors
+auto compression_levels(Compression) -> std::string;
+
+// Name of the codec, as given on the command line
+constexpr auto compression_string(Compression compression) -> char const* {
+  switch (compression) {
+    case Compression::NONE:
+      return NONE_COMPRESSION_STRING;
+    case Compression::GZIP:
+      return GZIP_COMPRESSION_STRING;
+    case Compression::ZSTD:
+      return ZSTD_COMPRESSION_STRING;
+  }
+  return GZIP_COMPRESSION_STRING;
+}
+
+// File extension of CSV files compressed with the given codec
+constexpr auto compression_extension(Compression compression) -> char const* {
+  switch (compression) {
+    case Compression::NONE:
+      return ".csv";
+    case Compression::GZIP:
+      return ".csv.gz";
+    case Compression::ZSTD:
+      return ".csv.zst";
+  }
+  return ".csv.gz";
+}
+
+auto operator>>(std::istream&, Compression&) -> std::istream&;
+
+}  // end of namespace cclyzer
+
+#endif /* COMPRESSION_HPP__ */
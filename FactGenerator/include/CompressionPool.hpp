@@ -0,0 +1,65 @@
+#ifndef COMPRESSION_POOL_H__
+#define COMPRESSION_POOL_H__
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cclyzer {
+class CompressionPool;
+}
+
+// Worker threads that compress and write out blocks of CSV records in the
+// background, so that fact generation doesn't have to wait for the codec. The
+// number of blocks in flight is bounded, which throttles the generator when
+// the workers can't keep up.
+class cclyzer::CompressionPool {
+ public:
+  CompressionPool(std::size_t threads, std::size_t maxPendingBlocks);
+  ~CompressionPool();
+
+  /* Non-copyable */
+  CompressionPool(const CompressionPool &other) = delete;
+  auto operator=(const CompressionPool &) -> CompressionPool & = delete;
+
+  /* Count a new pending block, waiting until there's room for it */
+  void acquireBlock();
+
+  /* Count a pending block as written */
+  void releaseBlock();
+
+  /* Run a task on one of the worker threads. Tasks must not throw; they hand
+   * errors back to their submitter instead, see csv_writer::drain. */
+  void submit(std::function<void()> task);
+
+ private:
+  /* Worker thread loop */
+  void run();
+
+  /* Guards all of the below */
+  std::mutex mutex;
+
+  /* Signaled when a task is submitted, or when the pool shuts down */
+  std::condition_variable taskAdded;
+
+  /* Signaled when a pending block is written */
+  std::condition_variable blockReleased;
+
+  /* Tasks that weren't picked up by a worker yet */
+  std::deque<std::function<void()>> tasks;
+
+  /* Number of blocks in flight, and its bound */
+  std::size_t pendingBlocks{0};
+  const std::size_t maxPendingBlocks;
+
+  /* Set on destruction, once no more tasks will be submitted */
+  bool stopping{false};
+
+  std::vector<std::thread> workers;
+};
+
+#endif /* COMPRESSION_POOL_H__ */
@@ -5,10 +5,29 @@
 #include <boost/filesystem/fstream.hpp>
 #include <boost/iostreams/device/file.hpp>
 #include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/zstd.hpp>
 #include <boost/iostreams/filtering_stream.hpp>
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <ios>
 #include <iostream>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_set>
 #include <utility>
+#include <vector>
+
+#include "Compression.hpp"
+#include "CompressionPool.hpp"
 
 namespace cclyzer {
 
@@ -21,6 +40,8 @@ struct is_serializable
           std::is_convertible<T, const char*>::value ||
               std::is_arithmetic<T>::value ||
               std::is_same<std::string, typename std::remove_cv<T>::type>::
+                  value ||
+              std::is_same<std::string_view, typename std::remove_cv<T>::type>::
                   value> {};
 
 // Define variadic serializable type trait that generalizes to
@@ -39,6 +60,77 @@ struct all_serializable<T> {
   static const bool value = is_serializable<T>::value;
 };
 
+// Define trait for types that are formatted with std::to_chars. Streams print
+// bool and the char types differently, and floating-point std::to_chars isn't
+// available everywhere, so these are still formatted by a stream.
+template <class T>
+struct is_to_chars_formattable
+    : std::integral_constant<
+          bool,
+          std::is_integral<T>::value &&
+              !std::is_same<bool, typename std::remove_cv<T>::type>::value &&
+              (sizeof(T) > 1)> {};
+
+// Records written to a CSV file, used to drop duplicate records. Outlives the
+// writers of its file, which may be closed and reopened. Keeps a copy of each
+// distinct record, so that records are only dropped if they are identical.
+class written_records {
+ public:
+  /* Add a record, returning false if it was already written */
+  auto insert(std::string_view row) -> bool {
+    if (rows.find(row) != rows.end()) {
+      return false;
+    }
+    rows.insert(store(row));
+    return true;
+  }
+
+  /* Number of dropped records */
+  std::size_t duplicates{0};
+
+ private:
+  /* Copy a record into the arena */
+  auto store(std::string_view row) -> std::string_view {
+    if (chunks.empty() ||
+        chunks.back().capacity() - chunks.back().size() < row.size()) {
+      chunks.emplace_back();
+      chunks.back().reserve(std::max(CHUNK_SIZE, row.size()));
+    }
+    // Stays within capacity, so views of earlier records remain valid
+    std::string& chunk = chunks.back();
+    const std::size_t offset = chunk.size();
+    chunk.append(row);
+    return {chunk.data() + offset, row.size()};
+  }
+
+  /* Size of the arena's chunks */
+  static constexpr std::size_t CHUNK_SIZE = 1U << 20U;
+
+  /* Arena owning the bytes of the distinct records */
+  std::deque<std::string> chunks;
+
+  /* Distinct records, viewing the arena */
+  std::unordered_set<std::string_view> rows;
+};
+
+// File sink that fails on short writes, e.g. once the disk is full. The
+// compressors would otherwise retry them forever.
+struct checked_file_sink : boost::iostreams::file_sink {
+  checked_file_sink(const std::string& path, BOOST_IOS::openmode mode)
+      : basic_file_sink(path, mode), path(path) {}
+
+  auto write(const char* s, std::streamsize n) -> std::streamsize {
+    const std::streamsize written = basic_file_sink::write(s, n);
+    if (written < n) {
+      throw std::ios_base::failure("Failed to write " + path);
+    }
+    return written;
+  }
+
+ private:
+  std::string path;
+};
+
 //-----------------------------------------------------------------------
 // Generic CSV writer class
 //-----------------------------------------------------------------------
@@ -53,26 +145,137 @@ class csv_writer {
   csv_writer(
       const path& csvfile,
       std::string delimiter = "\t",
-      BOOST_IOS::openmode mode = BOOST_IOS::out)
-      : out(), delim(std::move(delimiter)) {
-    out.push(boost::iostreams::gzip_compressor());
-    out.push(boost::iostreams::file_sink(csvfile.c_str(), mode));
+      Compression compression = Compression::GZIP,
+      int level = DEFAULT_COMPRESSION_LEVEL,
+      BOOST_IOS::openmode mode = BOOST_IOS::out,
+      CompressionPool* pool = nullptr,
+      written_records* written = nullptr)
+      : out(),
+        csvfile(csvfile),
+        delim(std::move(delimiter)),
+        written(written),
+        pool(pool) {
+    record.reserve(2 * BLOCK_SIZE);
+
+    if (!valid_compression_level(compression, level)) {
+      throw std::invalid_argument(
+          "Invalid compression level " + std::to_string(level) +
+          ", expected " + compression_levels(compression));
+    }
+
+    namespace io = boost::iostreams;
+
+    switch (compression) {
+      case Compression::NONE:
+        break;
+      case Compression::GZIP:
+        // zlib also uses -1 to denote its default level
+        out.push(io::gzip_compressor(io::gzip_params(level)));
+        break;
+      case Compression::ZSTD:
+        out.push(io::zstd_compressor(io::zstd_params(zstd_level(level))));
+        break;
+    }
+    out.push(checked_file_sink(csvfile.string(), mode));
 
     // Create parent directory
     create_directory(csvfile.parent_path());
   }
 
+  /* Writers that weren't closed are closed on a best-effort basis, ignoring
+   * errors. Pending blocks must be written before the writer goes away. */
+
+  ~csv_writer() {
+    try {
+      close();
+    } catch (...) {  // NOLINT(bugprone-empty-catch): reported by close()
+    }
+    waitDrained();
+  }
+
+  /* Non-copyable */
+  csv_writer(const csv_writer&) = delete;
+  auto operator=(const csv_writer&) -> csv_writer& = delete;
+
   /* Basic routines for appending new records to CSV files */
 
-  void write(const std::string& hdr) { out << hdr << "\n"; }
+  void write(std::string_view hdr) {
+    const std::size_t start = record.size();
+    record.append(hdr);
+    endRecord(start);
+  }
 
   template <typename V, typename... Vs>
-  void write(const std::string& hdr, const V& fld, const Vs&... flds) {
+  void write(std::string_view hdr, const V& fld, const Vs&... flds) {
     static_assert(
         all_serializable<V, Vs...>::value, "All types must be serializable");
-    out << hdr;
+    const std::size_t start = record.size();
+    record.append(hdr);
     appendFields(fld, flds...);
-    out << "\n";
+    endRecord(start);
+  }
+
+  /* Append a record with the given fields */
+  template <typename V>
+  void writeRow(const std::vector<V>& flds) {
+    static_assert(is_serializable<V>::value, "Type must be serializable");
+    const std::size_t start = record.size();
+    for (std::size_t i = 0; i < flds.size(); i++) {
+      if (i > 0) {
+        record.append(delim);
+      }
+      appendField(flds[i]);
+    }
+    endRecord(start);
+  }
+
+  /* Write out all buffered records and close the file, throwing
+   * std::ios_base::failure if anything couldn't be written */
+  void close() {
+    if (out.empty()) {
+      return;
+    }
+
+    flush();
+    waitDrained();
+    rethrowPoolError();
+    out.flush();
+    checkStream();
+
+    // Unlike destroying the stream, resetting it propagates the errors of
+    // closing the codec and the file
+    out.reset();
+  }
+
+  /* Hand buffered records over to the compression stream, or to the
+   * compression pool if there is one */
+  void flush() {
+    if (pool == nullptr) {
+      writeBlock(record);
+      record.clear();
+      return;
+    }
+
+    rethrowPoolError();
+    if (record.empty()) {
+      return;
+    }
+
+    pool->acquireBlock();
+    bool schedule = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      blocks.push_back(std::move(record));
+      schedule = !draining;
+      draining = true;
+    }
+    record = std::string();
+    record.reserve(2 * BLOCK_SIZE);
+
+    // At most one task per writer, so that blocks are written in order
+    if (schedule) {
+      pool->submit([this] { drain(); });
+    }
   }
 
  protected:
@@ -80,23 +283,166 @@ class csv_writer {
 
   void appendFields() {}
 
-  template <typename V, typename... Vargs>
-  void appendFields(const V& value) {
-    out << delim << value;
-  }
-
   template <typename V, typename... Vs>
   void appendFields(const V& value, const Vs&... values) {
-    appendFields(value);
+    record.append(delim);
+    appendField(value);
     appendFields(values...);
   }
 
+  /* Format a single field, exactly like operator<< would */
+
+  void appendField(const std::string& value) { record.append(value); }
+
+  void appendField(std::string_view value) { record.append(value); }
+
+  void appendField(const char* value) { record.append(value); }
+
+  template <typename V>
+  void appendField(const V& value) {
+    if constexpr (is_to_chars_formattable<V>::value) {
+      // Enough for the digits and sign of any integer
+      char chars[std::numeric_limits<V>::digits10 + 3];  // NOLINT
+      auto result = std::to_chars(std::begin(chars), std::end(chars), value);
+      record.append(std::begin(chars), result.ptr);
+    } else if constexpr (std::is_convertible<V, const char*>::value) {
+      record.append(static_cast<const char*>(value));
+    } else {  // NOLINT: clang-tidy doesn't know about "if constexpr"
+      formatter.str(std::string());
+      formatter << value;
+      record.append(formatter.str());
+    }
+  }
+
+  /* Write out pending blocks, on a thread of the compression pool */
+  void drain() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!blocks.empty()) {
+      std::string block = std::move(blocks.front());
+      blocks.pop_front();
+      const bool failed = static_cast<bool>(poolError);
+      lock.unlock();
+
+      // Once a block fails, the remaining ones are dropped. The error is
+      // rethrown on the writer's own thread.
+      std::exception_ptr blockError;
+      if (!failed) {
+        try {
+          writeBlock(block);
+        } catch (...) {
+          blockError = std::current_exception();
+        }
+      }
+      pool->releaseBlock();
+
+      lock.lock();
+      if (blockError) {
+        poolError = blockError;
+      }
+    }
+    draining = false;
+    drained.notify_all();
+  }
+
+  /* Write a block of records to the stream, throwing if that fails */
+  void writeBlock(const std::string& block) {
+    out.write(block.data(), static_cast<std::streamsize>(block.size()));
+    checkStream();
+  }
+
+  /* Throw if writing to the stream failed */
+  void checkStream() {
+    if (!out) {
+      throw std::ios_base::failure("Failed to write " + csvfile.string());
+    }
+  }
+
+  /* Rethrow the error of the compression pool writing this writer's blocks,
+   * if there was one */
+  void rethrowPoolError() {
+    std::exception_ptr error;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      error = poolError;
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  /* Wait until the compression pool wrote all pending blocks, if any */
+  void waitDrained() {
+    if (pool != nullptr) {
+      std::unique_lock<std::mutex> lock(mutex);
+      drained.wait(lock, [this] { return !draining; });
+    }
+  }
+
+  /* Terminate the current record, starting at given offset of the buffer,
+   * dropping it if it's a duplicate and writing out full blocks */
+  void endRecord(std::size_t start) {
+    record.push_back('\n');
+    if (written != nullptr) {
+      std::string_view row(record.data() + start, record.size() - start);
+      if (!written->insert(row)) {
+        record.resize(start);
+        written->duplicates++;
+        return;
+      }
+    }
+    if (record.size() >= BLOCK_SIZE) {
+      flush();
+    }
+  }
+
  private:
-  /* Compression stream */
+  /* Level of zstd_params. Boost keeps the level unsigned, but hands it to zstd
+   * as the signed int it started out as, so negative levels survive the round
+   * trip. */
+  static auto zstd_level(int level) -> uint32_t {
+    return level == DEFAULT_COMPRESSION_LEVEL
+               ? boost::iostreams::zstd::default_compression
+               : static_cast<uint32_t>(level);
+  }
+
+  /* Amount of buffered records handed to the stream at once */
+  static constexpr std::size_t BLOCK_SIZE = 1U << 16U;
+
+  /* Compression stream, empty once closed */
   boost::iostreams::filtering_ostream out;
 
+  /* Path of the CSV file, for error messages */
+  const path csvfile;
+
   /* Column Delimiter */
   const std::string delim;
+
+  /* Buffer of formatted records, not yet written to the stream */
+  std::string record;
+
+  /* Fallback formatter for fields that std::to_chars doesn't handle */
+  std::ostringstream formatter;
+
+  /* Records written so far, if dropping duplicates */
+  written_records* const written;
+
+  /* Pool for background compression, if any */
+  CompressionPool* const pool;
+
+  /* Guards the state of background compression below */
+  std::mutex mutex;
+
+  /* Signaled when all pending blocks were written */
+  std::condition_variable drained;
+
+  /* Blocks of records waiting for the pool */
+  std::deque<std::string> blocks;
+
+  /* Whether a pool task is writing out this writer's blocks */
+  bool draining{false};
+
+  /* First error of the compression pool writing this writer's blocks */
+  std::exception_ptr poolError;
 };
 
 }  // end of namespace cclyzer
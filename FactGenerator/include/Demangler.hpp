@@ -1,34 +1,63 @@
 #ifndef DEMANGLER_HPP__
 #define DEMANGLER_HPP__
 
-#include <cxxabi.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
 
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
 #include <memory>
 #include <string>
+#include <string_view>
 
+// Demangler of C++ names, which memoizes demangled names until cleared, and
+// reuses a single output buffer for the names it does demangle
 class Demangler {
  public:
+  // Hit and miss counts of memoized names, and time spent demangling
+  struct CacheStats {
+    std::size_t hits{0};
+    std::size_t misses{0};
+    std::chrono::nanoseconds time{0};
+  };
+
+  Demangler() = default;
+
+  /* Non-copyable */
+  Demangler(const Demangler&) = delete;
+  auto operator=(const Demangler&) -> Demangler& = delete;
+
   /* NOTE(ww): Stolen from Demangle.cpp (not present in LLVM 7).
    */
-  static inline auto is_itanium_encoding(const std::string& MangledName)
-      -> bool {
+  static inline auto is_itanium_encoding(llvm::StringRef MangledName) -> bool {
     size_t pos = MangledName.find_first_not_of('_');
     // A valid Itanium encoding requires 1-4 leading underscores, followed by
     // 'Z'.
     return pos > 0 && pos <= 4 && MangledName[pos] == 'Z';
   }
 
-  static inline auto demangle(const char* name) -> std::string {
-    int status = -1;
+  // Demangled name, or the name itself if it isn't a valid Itanium encoding.
+  // Only valid until the demangler is cleared (or the name goes away).
+  auto demangle(llvm::StringRef name) -> std::string_view;
 
-    std::unique_ptr<char, void (*)(void*)> res{
-        abi::__cxa_demangle(name, nullptr, nullptr, &status), std::free};
-    return (status == 0) ? res.get() : std::string(name);
-  }
+  // Forget all memoized names, e.g. those of a previous module
+  void clearDemangled() { demangled.clear(); }
 
-  static inline auto demangle(const std::string& name) -> std::string {
-    return demangle(name.c_str());
-  }
+  [[nodiscard]] auto demangleCacheStats() const -> CacheStats { return stats; }
+
+ protected:
+  // Add the given statistics to those of this demangler
+  void addDemangleCacheStats(const CacheStats& other);
+
+ private:
+  llvm::StringMap<std::string> demangled;
+
+  /* Output buffer of __cxa_demangle, grown as needed */
+  std::unique_ptr<char, void (*)(void*)> buffer{nullptr, std::free};
+  std::size_t bufferSize{0};
+
+  CacheStats stats;
 };
 
 #endif /* DEMANGLER_HPP__ */
@@ -0,0 +1,64 @@
+#ifndef FACT_BUFFER_H__
+#define FACT_BUFFER_H__
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "FactSink.hpp"
+#include "FactWriter.hpp"
+#include "Predicate.hpp"
+
+namespace cclyzer {
+
+class FactCache;
+
+// Fact sink that keeps facts in memory, so that they can be written out later,
+// in the order they were inserted, possibly on another thread. The fields of
+// all facts are packed into a single string to keep allocations down.
+class FactBuffer : public FactSink {
+ public:
+  FactBuffer() = default;
+  ~FactBuffer() override = default;
+
+  void insert(const Predicate &pred, const std::vector<std::string> &fields)
+      override;
+
+  /* Write all buffered facts to the given writer, and clear the buffer */
+  void writeTo(FactWriter &writer);
+
+  /* Exchange buffered facts with another buffer */
+  void swap(FactBuffer &other) noexcept {
+    facts.swap(other.facts);
+    fieldEnds.swap(other.fieldEnds);
+    data.swap(other.data);
+  }
+
+ private:
+  /* Reads and writes buffered facts directly */
+  friend class FactCache;
+
+  /* Single buffered fact */
+  struct fact {
+    const Predicate *pred;
+
+    /* Index of its first field in fieldEnds */
+    std::size_t firstField;
+  };
+
+  std::vector<fact> facts;
+
+  /* End offset of each field in data */
+  std::vector<std::size_t> fieldEnds;
+
+  /* Contents of all fields, back to back */
+  std::string data;
+
+  /* Reusable buffer of fields, for writing out a single fact */
+  std::vector<std::string_view> row;
+};
+
+}  // end of namespace cclyzer
+
+#endif /* FACT_BUFFER_H__ */
@@ -0,0 +1,91 @@
+#ifndef FACT_CACHE_H__
+#define FACT_CACHE_H__
+
+#include <llvm/Support/MD5.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <atomic>
+#include <boost/filesystem.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "FactBuffer.hpp"
+#include "Predicate.hpp"
+
+namespace cclyzer {
+
+// Persistent cache of the facts of single functions, keyed by a digest of
+// everything those facts depend on, so that unchanged functions needn't be
+// processed again on later runs. Each entry is a file of its own, replaced
+// atomically, so that several fact generators (even in different processes)
+// can share a cache directory.
+class FactCache {
+ public:
+  /* Cache in the given directory, created if need be. Entries are only ever
+   * reused by the same build of the fact generator. */
+  explicit FactCache(boost::filesystem::path directory);
+
+  /* Non-copyable */
+  FactCache(const FactCache &) = delete;
+  auto operator=(const FactCache &) -> FactCache & = delete;
+
+  /* Stream computing a cache key from everything written to it */
+  class key_stream : public llvm::raw_ostream {
+   public:
+    key_stream() { SetUnbuffered(); }
+
+    /* Finish computing the key, as a hex string */
+    auto key() -> std::string;
+
+   private:
+    void write_impl(const char *ptr, std::size_t size) override;
+    [[nodiscard]] auto current_pos() const -> std::uint64_t override {
+      return pos;
+    }
+
+    llvm::MD5 hasher;
+    std::uint64_t pos = 0;
+  };
+
+  /* Look up the facts of a function, and the refmodes of the types they
+   * refer to. Missing or unreadable entries count as misses. */
+  auto load(
+      const std::string &key,
+      FactBuffer &facts,
+      std::vector<std::string> &types) -> bool;
+
+  /* Store the facts of a function, and the refmodes of the types they refer
+   * to. Entries that can't be written are skipped, since they can always be
+   * recomputed. */
+  void store(
+      const std::string &key,
+      const FactBuffer &facts,
+      const std::vector<std::string> &types);
+
+  /* Number of lookups that did, or did not, find an entry */
+  [[nodiscard]] auto hits() const -> std::size_t { return hitCount; }
+  [[nodiscard]] auto misses() const -> std::size_t { return missCount; }
+
+ private:
+  /* Path of the entry with the given key */
+  [[nodiscard]] auto entryPath(const std::string &key) const
+      -> boost::filesystem::path;
+
+  boost::filesystem::path directory;
+
+  /* Identity of the running build of the fact generator */
+  std::string build;
+
+  /* Predicates by name, to read back facts */
+  std::map<std::string, const Predicate *> predicates;
+
+  std::atomic<std::size_t> hitCount{0};
+  std::atomic<std::size_t> missCount{0};
+};
+
+}  // end of namespace cclyzer
+
+#endif /* FACT_CACHE_H__ */
@@ -1,6 +1,7 @@
 #ifndef FACT_GENERATOR_H__
 #define FACT_GENERATOR_H__
 
+#include <llvm/ADT/SetVector.h>
 #include <llvm/IR/Constants.h>
 #include <llvm/IR/DataLayout.h>
 #include <llvm/IR/GlobalValue.h>
@@ -10,8 +11,6 @@
 #include <llvm/IR/Value.h>
 #include <llvm/Support/raw_ostream.h>
 
-#include <boost/flyweight.hpp>
-#include <boost/unordered_map.hpp>
 #include <boost/unordered_set.hpp>
 #include <set>
 #include <string>
@@ -23,9 +22,12 @@
 #include "PredicateGroups.hpp"
 #include "RefmodeEngine.hpp"
 #include "Signatures.hpp"
+#include "ValueTable.hpp"
 
 namespace cclyzer {
+class FactCache;
 class FactGenerator;
+class InstructionVisitor;
 }
 
 class cclyzer::FactGenerator : private RefmodeEngine,
@@ -34,47 +36,73 @@ class cclyzer::FactGenerator : private RefmodeEngine,
   friend class InstructionVisitor;
   friend class TypeVisitor;
   using RefmodeEngine::refmode;
+  using RefmodeEngine::refmodeView;
 
  public:
   /* No default constructor */
   FactGenerator() = delete;
 
+  /* Fact generator writing to the given fact writer, and reusing the facts
+   * of unchanged functions from the given cache, if any. Fact generators are
+   * independent of each other, and can be used on different threads, even
+   * with the same cache. */
+  explicit FactGenerator(FactWriter &writer, FactCache *cache = nullptr)
+      : ForwardingFactWriter(writer), cache(cache) {}
+
   /* Non-copyable */
   FactGenerator(FactGenerator const &) = delete;
   auto operator=(FactGenerator const &) -> FactGenerator & = delete;
 
-  /* Get fact generator instance for a given fact writer */
-  static auto getInstance(FactWriter &) -> FactGenerator &;
+  /* Refmode memoization statistics */
+  using RefmodeEngine::typeCacheStats;
+  using RefmodeEngine::valueCacheStats;
+
+  /* Demangling memoization statistics */
+  using Demangler::demangleCacheStats;
 
   /* Fact Writing Methods */
   auto writeConstant(const llvm::Constant &) -> refmode_t;
   auto writeAsm(const llvm::InlineAsm &) -> refmode_t;
 
+  /* Record a whole module, starting afresh, and return its values by refmode.
+   * Functions are processed on the given number of worker threads, or on the
+   * calling thread if zero. Either way, the facts of each function are written
+   * together, in module order. All function bodies must be loaded.
+   *
+   * Of functions whose facts come from the cache, only the functions
+   * themselves are among the returned values. */
   auto processModule(
       const llvm::Module &Mod,
       const std::string &path,
       const llvm::Optional<boost::filesystem::path> &signatures,
-      const ContextSensitivity &sensitivity)
-      -> std::map<boost::flyweight<std::string>, const llvm::Value *>;
+      const ContextSensitivity &sensitivity,
+      std::size_t threads = 0)
+      -> ValueTable;
+
+  /* Same as processModule on the calling thread and without the fact cache,
+   * for a lazily loaded module. Function bodies are loaded one at a time, and
+   * deleted once recorded; their instructions are then left out of the
+   * returned values. */
+  auto processLazyModule(
+      llvm::Module &Mod,
+      const std::string &path,
+      const llvm::Optional<boost::filesystem::path> &signatures,
+      const ContextSensitivity &sensitivity) -> ValueTable;
   void writeLocalVariables();
+
+  /* Record the types of the last processed module */
   void writeTypes(const llvm::DataLayout &layout);
 
  protected:
   /* Common type aliases */
-  using type_cache_t = boost::unordered_map<std::string, const llvm::Type *>;
   using pred_t = predicates::pred_t;
 
-  /* Constructor must initialize output file streams */
-  FactGenerator(FactWriter &writer) : ForwardingFactWriter(writer) {}
-
   /* Recording variables and types */
-  void recordVariable(const std::string &id, const llvm::Type *type) {
-    variableTypes[id] = type;
-  }
+  void recordVariable(const llvm::Value &var) { variables.insert(&var); }
 
-  auto recordType(const llvm::Type *type) -> refmode_t {
+  auto recordType(const llvm::Type *type) -> refmode_view_t {
     types.insert(type);
-    return refmode<llvm::Type>(*type);
+    return refmodeView<llvm::Type>(*type);
   }
 
   /* Auxiliary fact writing methods */
@@ -90,16 +118,67 @@ class cclyzer::FactGenerator : private RefmodeEngine,
   void writeGlobalAlias(const llvm::GlobalAlias &, const refmode_t &);
   void writeGlobalVar(const llvm::GlobalVariable &, const refmode_t &);
 
-  std::map<boost::flyweight<std::string>, const llvm::Value *> result_map_;
+  ValueTable value_table_;
 
  private:
+  using signature_list_t = SignatureList;
+
+  /* Bound on the functions processed ahead of the ones written, per worker
+   * thread */
+  static constexpr std::size_t MAX_PENDING_FUNCTIONS_PER_THREAD = 16;
+
+  /* Record a function, and its body unless it has a signature */
+  void processFunction(
+      const llvm::Function &, InstructionVisitor &, const signature_list_t &);
+
+  /* Same as processFunction, for a function whose body isn't loaded yet */
+  void processLazyFunction(
+      llvm::Function &, InstructionVisitor &, const signature_list_t &);
+
+  /* Common part of processModule and processLazyModule, which passes the
+   * module again as lazy */
+  auto processModule(
+      const llvm::Module &Mod,
+      llvm::Module *lazy,
+      const std::string &path,
+      const llvm::Optional<boost::filesystem::path> &signatures,
+      const ContextSensitivity &sensitivity,
+      std::size_t threads) -> ValueTable;
+
+  /* Process all functions of the current module as separate jobs, on worker
+   * threads if any, reusing their facts from the cache if any */
+  void processFunctionJobs(
+      const llvm::Module &Mod,
+      const std::string &path,
+      const signature_list_t &signatures,
+      std::size_t threads);
+
+  /* Cache keys: for the parts of the current module that the facts of all
+   * functions depend on, and for a single function given the former */
+  auto moduleCacheKey(
+      const llvm::Module &Mod,
+      const std::string &path,
+      const signature_list_t &signatures) -> std::string;
+  auto functionCacheKey(const llvm::Function &, const std::string &moduleKey)
+      -> std::string;
+
+  /* Find the types with the given refmodes among those of a function and its
+   * values, for its cached facts. Fails if any is missing. */
+  auto findCachedTypes(
+      const llvm::Function &,
+      const std::vector<std::string> &refmodes,
+      boost::unordered_set<const llvm::Type *> &found) -> bool;
+
   auto processSignatures(const boost::filesystem::path &signatures)
-      -> std::vector<std::tuple<std::string, std::regex, llvm::json::Array>>;
+      -> signature_list_t;
   void emitSignatures(
       const std::string &func, const llvm::json::Array &signatures);
 
-  /* Caches for variable types */
-  type_cache_t variableTypes;
+  /* Persistent cache of the facts of functions, if any */
+  FactCache *cache;
+
+  /* Variables of the current function, in the order they were recorded */
+  llvm::SetVector<const llvm::Value *> variables;
 
   /* Auxiliary methods */
   boost::unordered_set<const llvm::Type *> types;
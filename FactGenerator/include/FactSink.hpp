@@ -0,0 +1,57 @@
+#ifndef FACT_SINK_H__
+#define FACT_SINK_H__
+
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "Predicate.hpp"
+
+namespace cclyzer {
+
+// Destination for facts that bypasses the filesystem entirely, e.g., the
+// relations of an embedded Souffle program. Each fact is handed over as a row
+// of fields, serialized exactly as they would appear in a CSV file.
+class FactSink {
+ public:
+  FactSink() = default;
+  virtual ~FactSink() = default;
+
+  // Non-copyable
+  FactSink(const FactSink &other) = delete;
+  auto operator=(const FactSink &) -> FactSink & = delete;
+
+  virtual void insert(
+      const Predicate &pred, const std::vector<std::string> &fields) = 0;
+
+  /* Field serialization, matching the output of csv_writer */
+
+  static void toField(std::string &field, const std::string &value) {
+    field.assign(value);
+  }
+
+  static void toField(std::string &field, std::string_view value) {
+    field.assign(value);
+  }
+
+  static void toField(std::string &field, const char *value) {
+    field.assign(value);
+  }
+
+  template <typename V>
+  static void toField(std::string &field, const V &value) {
+    if constexpr (std::is_integral<V>::value && !std::is_same<V, char>::value) {
+      field.assign(std::to_string(value));
+    } else {  // NOLINT: clang-tidy doesn't know about "if constexpr"
+      std::ostringstream stream;
+      stream << value;
+      field.assign(stream.str());
+    }
+  }
+};
+
+}  // end of namespace cclyzer
+
+#endif /* FACT_SINK_H__ */
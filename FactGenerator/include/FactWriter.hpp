@@ -1,11 +1,22 @@
 #ifndef FACT_WRITER_H__
 #define FACT_WRITER_H__
 
+#include <llvm/Support/xxhash.h>
+
 #include <boost/filesystem.hpp>
-#include <boost/unordered_map.hpp>
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
+#include "Compression.hpp"
+#include "CompressionPool.hpp"
 #include "CsvWriter.hpp"
+#include "FactSink.hpp"
 #include "Predicate.hpp"
 #include "RefmodeEngine.hpp"  // TODO replace
 
@@ -20,13 +31,31 @@ class cclyzer::FactWriter {
   using path = boost::filesystem::path;
   using string = std::string;
 
+  /* Default bound on the number of simultaneously open CSV files */
+  static constexpr std::size_t DEFAULT_MAX_OPEN_FILES = 256;
+
+  /* Name of the file of interned symbols, without extension. The symbol with
+   * ID n is on line n (counting from 0). */
+  static constexpr const char* SYMBOLS_FILE = "symbols";
+
+  /* Start of the integer fields of interned facts, which are written as is
+   * rather than as symbol IDs */
+  static constexpr char INTEGER_PREFIX = '#';
+
   FactWriter(
       const Registry<Predicate>& registry,
       path outputDirectory,
       string delimiter,
+      Compression compression = Compression::GZIP,
+      int compressionLevel = DEFAULT_COMPRESSION_LEVEL,
+      std::size_t maxOpenFiles = DEFAULT_MAX_OPEN_FILES,
+      std::size_t compressionThreads = 0,
+      bool deduplicate = false,
+      bool internSymbols = false,
       BOOST_IOS::openmode mode = BOOST_IOS::out);
   FactWriter(const Registry<Predicate>& registry, path outputDirectory);
   FactWriter(const Registry<Predicate>& registry);
+  FactWriter(FactSink& sink);
   ~FactWriter();
 
   /* Non-default */
@@ -38,48 +67,193 @@ class cclyzer::FactWriter {
 
   /* Delegation to fact writer instance  */
 
-  void writeFact(const Predicate& pred, const refmode_t& refmode) {
+  void writeFact(const Predicate& pred, refmode_view_t refmode) {
+    if (sink != nullptr) {
+      sinkFact(pred, refmode);
+      return;
+    }
+    if (symbols) {
+      internFact(pred, refmode);
+      return;
+    }
     getWriter(pred)->write(refmode);
   }
 
   template <typename V, typename... Vs>
   void writeFact(
       const Predicate& pred,
-      const refmode_t& refmode,
+      refmode_view_t refmode,
       const V& val,
       const Vs&... vals) {
+    if (sink != nullptr) {
+      sinkFact(pred, refmode, val, vals...);
+      return;
+    }
+    if (symbols) {
+      internFact(pred, refmode, val, vals...);
+      return;
+    }
     getWriter(pred)->write(refmode, val, vals...);
   }
 
+  /* Create the files of predicates without any facts, and write out and close
+   * all files, throwing std::ios_base::failure if anything couldn't be
+   * written. Must be called once all facts were written; the destructor only
+   * does so on a best-effort basis, ignoring errors. */
+  void close();
+
+  /* Write a single fact whose fields were already serialized, see FactSink */
+  void writeFields(
+      const Predicate& pred, const std::vector<std::string_view>& row);
+
+  /* Number of dropped duplicate facts so far, with predicate name as key */
+  [[nodiscard]] auto getDuplicates() const -> std::map<string, std::size_t>;
+
  protected:
-  /* Get CSV writer instance for given predicate */
-  auto getWriter(const Predicate& pred) -> csv_writer*;
+  /* Get CSV writer instance for given predicate, opening it if needed */
+  auto getWriter(const Predicate& pred) -> csv_writer* {
+    const std::size_t index = pred.getIndex();
+    if (index >= fileIndex.size() || fileIndex[index] == NO_FILE) {
+      return openWriter(addFile(pred));
+    }
+
+    writer_slot& slot = files[fileIndex[index]];
+    if (!slot.writer) {
+      return openWriter(fileIndex[index]);
+    }
+
+    // Mark as most recently used
+    if (openWriters.begin() != slot.lru) {
+      openWriters.splice(openWriters.begin(), openWriters, slot.lru);
+    }
+    return slot.writer.get();
+  }
+
+  /* Get (or add) the CSV file of given predicate */
+  auto addFile(const Predicate& pred) -> std::size_t;
+
+  /* Open the CSV writer of given file, closing the least recently used one
+   * if too many are open */
+  auto openWriter(std::size_t file) -> csv_writer*;
 
   /* Filesystem path computation  */
   auto getPath(const Predicate& pred) -> path;
 
-  /* Exhaustive CSV writer initialization */
+  /* Register every predicate, so that each gets a (possibly empty) file */
   void init_writers(const Registry<Predicate>&);
 
- private:
-  /* Map type */
-  template <typename K, typename V>
-  using map = boost::unordered_map<K, V>;
+  /* Serialize the fields of a single fact into the fields buffer */
+  template <typename... Vs>
+  void serializeFields(const Vs&... vals) {
+    static_assert(
+        all_serializable<Vs...>::value, "All types must be serializable");
+    fields.resize(sizeof...(Vs));
+    auto field = fields.begin();
+    (FactSink::toField(*field++, vals), ...);
+  }
+
+  /* Hand a single fact over to the fact sink */
+  template <typename... Vs>
+  void sinkFact(const Predicate& pred, const Vs&... vals) {
+    serializeFields(vals...);
+    sink->insert(pred, fields);
+  }
+
+  /* Write a single fact as the IDs of its interned fields */
+  template <typename... Vs>
+  void internFact(const Predicate& pred, const Vs&... vals) {
+    serializeFields(vals...);
+    internFields(pred);
+  }
+
+  /* Write the fields buffer as the IDs of its interned fields. Integers
+   * aren't interned, but written as is after INTEGER_PREFIX. */
+  void internFields(const Predicate& pred);
+
+  /* Get the ID of a symbol, adding it to the symbols file if it's new */
+  auto internSymbol(const string& symbol) -> std::size_t;
 
+ private:
   /* Column Delimiter */
   const string delim;
 
   /* Output directory */
   const path outdir;
 
+  /* Codec and level for output CSV */
+  const Compression compression;
+  const int compressionLevel;
+
+  /* Maximum number of simultaneously open CSV writers */
+  const std::size_t maxOpenFiles;
+
+  /* Whether to drop duplicate facts */
+  const bool deduplicate;
+
   /* Open mode for output CSV */
   const BOOST_IOS::openmode mode;
 
-  /* Map of CSV writers with predicate name as key */
-  map<string, csv_writer*> writers;
+  /* State of a single CSV file */
+  struct writer_slot {
+    /* First predicate written to this file */
+    const Predicate* pred{nullptr};
+
+    /* Open writer, or null if the file is currently closed */
+    std::unique_ptr<csv_writer> writer;
+
+    /* Whether the file was already created, and must now be appended to */
+    bool created{false};
+
+    /* Position in the list of open writers */
+    std::list<std::size_t>::iterator lru;
+
+    /* Records written so far, if dropping duplicates */
+    std::unique_ptr<written_records> written;
+  };
+
+  /* Threads compressing CSV records in the background, if any. Must outlive
+   * the CSV writers. */
+  std::unique_ptr<CompressionPool> pool;
+
+  /* Bound on the blocks of records in flight, per compression thread */
+  static constexpr std::size_t MAX_PENDING_BLOCKS_PER_THREAD = 4;
+
+  /* Placeholder for predicates without a file */
+  static constexpr std::size_t NO_FILE = static_cast<std::size_t>(-1);
+
+  /* CSV files, which are all created on completion */
+  std::vector<writer_slot> files;
+
+  /* Map of CSV files with predicate name as key */
+  std::map<string, std::size_t> fileNames;
+
+  /* CSV files, indexed by predicate index. Predicates may share a file. */
+  std::vector<std::size_t> fileIndex;
+
+  /* CSV files with open writers, most recently used first */
+  std::list<std::size_t> openWriters;
+
+  /* Writer of interned symbols, if interning them */
+  std::unique_ptr<csv_writer> symbols;
+
+  /* Hash of symbols, faster than std::hash on long ones */
+  struct symbol_hash {
+    auto operator()(const string& s) const -> std::size_t {
+      return llvm::xxHash64(s);
+    }
+  };
+
+  /* IDs of interned symbols */
+  std::unordered_map<string, std::size_t, symbol_hash> symbolTable;
+
+  /* In-memory destination of facts, replacing the CSV writers if set */
+  FactSink* sink{nullptr};
+
+  /* Reusable buffer of serialized fields, for the fact sink and interning */
+  std::vector<string> fields;
 
-  /* CSV file extension */
-  static const string FILE_EXTENSION;
+  /* Reusable buffer of interned fields */
+  std::vector<string> internedFields;
 };
 
 #endif /* FACT_WRITER_H__ */
@@ -4,9 +4,12 @@
 #include <llvm/ADT/Optional.h>
 
 #include <boost/filesystem.hpp>
+#include <cstddef>
 #include <string>
 
+#include "Compression.hpp"
 #include "ContextSensitivity.hpp"
+#include "FactWriter.hpp"
 
 namespace cclyzer {
 // Main fact-generation routines
@@ -19,7 +22,23 @@ void factgen(
     const llvm::Optional<boost::filesystem::path> &signatures,
     const ContextSensitivity &context_sensitivity) {
   return factgen(
-      firstFile, endFile, outputDir, signatures, context_sensitivity, "\t");
+      firstFile,
+      endFile,
+      outputDir,
+      signatures,
+      context_sensitivity,
+      "\t",
+      Compression::GZIP,
+      DEFAULT_COMPRESSION_LEVEL,
+      FactWriter::DEFAULT_MAX_OPEN_FILES,
+      0,
+      0,
+      0,
+      llvm::Optional<boost::filesystem::path>(),
+      false,
+      false,
+      false,
+      false);
 }
 
 template <typename FileIt>
@@ -29,7 +48,18 @@ void factgen(
     const boost::filesystem::path &outputDir,
     const llvm::Optional<boost::filesystem::path> &signatures,
     const ContextSensitivity &context_sensitivity,
-    const std::string &delim);
+    const std::string &delim,
+    Compression compression,
+    int compression_level,
+    std::size_t max_open_files,
+    std::size_t compression_threads,
+    std::size_t function_threads,
+    std::size_t jobs,
+    const llvm::Optional<boost::filesystem::path> &fact_cache,
+    bool deduplicate,
+    bool intern_symbols,
+    bool lazy,
+    bool print_stats);
 }  // namespace cclyzer
 
 #endif /* FACT_GENERATOR_HPP__ */
@@ -10,15 +10,15 @@ class ForwardingFactWriter {
 
   /* Delegation to fact writer instance */
 
-  void writeFact(const Predicate &pred, const refmode_t &refmode) {
+  void writeFact(const Predicate &pred, refmode_view_t refmode) {
     writer.writeFact(pred, refmode);
   }
 
   template <typename V, typename... Vs>
   void writeFact(
       const Predicate &pred,
-      const refmode_t &refmode,
-      const V val,
+      refmode_view_t refmode,
+      const V &val,
       const Vs &...vals) {
     writer.writeFact(pred, refmode, val, vals...);
   }
@@ -4,8 +4,10 @@
 #include <llvm/ADT/Optional.h>
 
 #include <boost/filesystem.hpp>
+#include <cstddef>
 #include <string>
 
+#include "Compression.hpp"
 #include "ContextSensitivity.hpp"
 
 namespace cclyzer {
@@ -34,6 +36,42 @@ class cclyzer::Options {
     return context_sensitivity;
   }
 
+  [[nodiscard]] auto get_compression() const -> Compression {
+    return compression;
+  }
+
+  [[nodiscard]] auto get_compression_level() const -> int {
+    return compression_level;
+  }
+
+  [[nodiscard]] auto get_max_open_files() const -> std::size_t {
+    return max_open_files;
+  }
+
+  [[nodiscard]] auto get_compression_threads() const -> std::size_t {
+    return compression_threads;
+  }
+
+  [[nodiscard]] auto get_function_threads() const -> std::size_t {
+    return function_threads;
+  }
+
+  [[nodiscard]] auto get_jobs() const -> std::size_t { return jobs; }
+
+  [[nodiscard]] auto get_deduplicate() const -> bool { return deduplicate; }
+
+  [[nodiscard]] auto get_intern_symbols() const -> bool {
+    return intern_symbols;
+  }
+
+  [[nodiscard]] auto get_fact_cache() const -> const llvm::Optional<path>& {
+    return fact_cache;
+  }
+
+  [[nodiscard]] auto get_lazy() const -> bool { return lazy; }
+
+  [[nodiscard]] auto get_print_stats() const -> bool { return print_stats; }
+
   [[nodiscard]] auto input_file_begin() const -> input_file_iterator {
     return inputFiles.begin();
   }
@@ -70,6 +108,31 @@ class cclyzer::Options {
   std::vector<boost::filesystem::path> inputFiles;
 
   ContextSensitivity context_sensitivity;
+
+  /* Compression of generated facts */
+  Compression compression;
+  int compression_level;
+  std::size_t compression_threads;
+  std::size_t function_threads;
+  std::size_t jobs;
+
+  /* Drop duplicate facts */
+  bool deduplicate;
+
+  /* Write IDs of interned symbols rather than the symbols */
+  bool intern_symbols;
+
+  /* Directory caching the facts of functions */
+  llvm::Optional<boost::filesystem::path> fact_cache;
+
+  /* Load function bodies on demand */
+  bool lazy;
+
+  /* Print statistics about fact generation */
+  bool print_stats;
+
+  /* Bound on simultaneously open fact files */
+  std::size_t max_open_files;
 };
 
 #endif
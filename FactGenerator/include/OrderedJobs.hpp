@@ -0,0 +1,26 @@
+#ifndef ORDERED_JOBS_H__
+#define ORDERED_JOBS_H__
+
+#include <cstddef>
+#include <functional>
+
+namespace cclyzer {
+
+// Run work(thread, job) for each job in [0, jobs) on the given number of
+// worker threads, and consume(job) for each job on the calling thread, in job
+// order. Workers are at most maxPendingJobs jobs ahead of the consumer, which
+// bounds the memory held by unconsumed jobs. Without worker threads, all jobs
+// run on the calling thread, as thread 0.
+//
+// If a job (or its consumer) throws, no further jobs are started or consumed,
+// and the exception is rethrown once all worker threads are stopped.
+void run_ordered_jobs(
+    std::size_t jobs,
+    std::size_t threads,
+    std::size_t maxPendingJobs,
+    const std::function<void(std::size_t thread, std::size_t job)> &work,
+    const std::function<void(std::size_t job)> &consume);
+
+}  // end of namespace cclyzer
+
+#endif /* ORDERED_JOBS_H__ */
@@ -1,6 +1,7 @@
 #ifndef PREDICATE_H__
 #define PREDICATE_H__
 
+#include <cstddef>
 #include <memory>
 #include <set>
 #include <string>
@@ -37,14 +38,18 @@ class Registry {
 
 class cclyzer::Predicate {
  public:
-  Predicate(const char *name) : name(name) {}
-  Predicate(std::string name) : name(std::move(name)) {}
+  Predicate(const char *name, std::size_t index) : name(name), index(index) {}
+  Predicate(std::string name, std::size_t index)
+      : name(std::move(name)), index(index) {}
   Predicate(const Predicate &other) = delete;  // non construction-copyable
   auto operator=(const Predicate &) -> Predicate & = delete;  // non copyable
 
   // Conversions
 
-  [[nodiscard]] auto getName() const -> std::string { return name; }
+  [[nodiscard]] auto getName() const -> const std::string & { return name; }
+
+  // Dense index of this predicate, for array-based lookups keyed by predicate
+  [[nodiscard]] auto getIndex() const -> std::size_t { return index; }
 
   [[nodiscard]] operator std::string() const { return name; }
 
@@ -68,6 +73,7 @@ class cclyzer::Predicate {
 
  private:
   const std::string name;
+  const std::size_t index;
 };
 
 #endif
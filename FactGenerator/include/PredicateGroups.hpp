@@ -14,6 +14,16 @@ struct predicate_group {};
 // The predicates
 extern Registry<pred_t> const predicates_reg;
 
+// Dense predicate indices, in order of declaration. Each predicate g::p gets
+// the index g_p, and NUM_PREDICATES bounds them all.
+enum predicate_index : std::size_t {
+#define GROUP_BEGIN(g)
+#define GROUP_END(g)
+#define PREDICATE(g, p, f) g##_##p,
+#include "./predicates.inc"
+  NUM_PREDICATES
+};
+
 //----------------------------------------------------
 // Predicate group definitions, from this point on.
 //----------------------------------------------------
@@ -9,21 +9,32 @@
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Type.h>
 #include <llvm/IR/Value.h>
+#include <llvm/Support/raw_ostream.h>
 
 #include <boost/flyweight.hpp>
+#include <cstddef>
 #include <string>
+#include <string_view>
 
 namespace cclyzer {
 
 namespace refmode {
 /* Type aliases */
 typedef std::string refmode_t;
+typedef std::string_view refmode_view_t;
 }  // namespace refmode
 
 using refmode_t = refmode::refmode_t;
+using refmode_view_t = refmode::refmode_view_t;
 
 class RefmodeEngine {
  public:
+  // Hit and miss counts of memoized refmodes
+  struct CacheStats {
+    std::size_t hits{0};
+    std::size_t misses{0};
+  };
+
   RefmodeEngine();
   virtual ~RefmodeEngine();
 
@@ -41,6 +52,22 @@ class RefmodeEngine {
   template <typename T>
   auto refmode(const T& obj) const -> refmode_t;
 
+  // Same as refmode, but without copying the refmode out of the arena that
+  // backs the refmode cache. Only valid until the next module is entered.
+  // Available for values, basic blocks and types.
+  template <typename T>
+  auto refmodeView(const T& obj) const -> refmode_view_t;
+
+  // Memoization statistics, for refmodes of values (and basic blocks) within
+  // functions, and for refmodes of types
+  [[nodiscard]] auto valueCacheStats() const -> CacheStats;
+  [[nodiscard]] auto typeCacheStats() const -> CacheStats;
+
+  // Print a function, global variable or metadata as LLVM assembly, numbering
+  // metadata as in refmodes
+  void print(const llvm::GlobalValue& global, llvm::raw_ostream& out) const;
+  void print(const llvm::Metadata& meta, llvm::raw_ostream& out) const;
+
  private:
   /* Opaque Pointer Idiom */
   class Impl;
@@ -99,6 +126,15 @@ extern template refmode_t RefmodeEngine::refmode<llvm::DINode>(
 extern template refmode_t RefmodeEngine::refmode<llvm::MDNode>(
     const llvm::MDNode&) const;
 
+extern template refmode_view_t RefmodeEngine::refmodeView<llvm::Type>(
+    const llvm::Type&) const;
+
+extern template refmode_view_t RefmodeEngine::refmodeView<llvm::BasicBlock>(
+    const llvm::BasicBlock&) const;
+
+extern template refmode_view_t RefmodeEngine::refmodeView<llvm::Value>(
+    const llvm::Value&) const;
+
 }  // end of namespace cclyzer
 
 #endif /* REFMODE_ENGINE_HPP__ */
@@ -1,17 +1,88 @@
+#ifndef SIGNATURES_H__
+#define SIGNATURES_H__
+
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/Support/JSON.h>
 
+#include <cstddef>
+#include <cstdint>
 #include <fstream>
 #include <regex>
 #include <set>
 #include <string>
+#include <tuple>
+#include <vector>
 
 #include "ForwardingFactWriter.hpp"
 #include "PredicateGroups.hpp"
 
+namespace cclyzer {
+
+// Points-to signatures, along with the patterns of the (demangled) function
+// names they apply to. Patterns are matched against names all at once: each
+// pattern is reduced to a literal string that its matches must contain, and
+// a single pass over a name finds all such literals in it (Aho-Corasick). Only
+// the patterns whose literal was found are then tried as regular expressions.
+class SignatureList {
+ public:
+  /* Pattern, as a string and compiled, and its signatures */
+  using entry_t = std::tuple<std::string, std::regex, llvm::json::Array>;
+
+  SignatureList() = default;
+  explicit SignatureList(std::vector<entry_t> entries);
+
+  using const_iterator = std::vector<entry_t>::const_iterator;
+  [[nodiscard]] auto begin() const -> const_iterator { return entries.begin(); }
+  [[nodiscard]] auto end() const -> const_iterator { return entries.end(); }
+  [[nodiscard]] auto empty() const -> bool { return entries.empty(); }
+
+  /* Signatures of all patterns that match the given name, in order */
+  [[nodiscard]] auto matching(const std::string &name) const
+      -> std::vector<const llvm::json::Array *>;
+
+ private:
+  /* State of the automaton, i.e., a prefix of some literals */
+  struct state {
+    /* Longest proper suffix that is a state too */
+    std::uint32_t fail = 0;
+
+    /* Longest proper suffix that is a whole literal, if any */
+    std::uint32_t output = 0;
+
+    /* Patterns whose literal is this state */
+    std::vector<std::size_t> patterns;
+  };
+
+  /* Add the literal of the given pattern to the automaton */
+  void addLiteral(const std::string &literal, std::size_t pattern);
+
+  /* Compute failure and output links, once all literals are added */
+  void link();
+
+  /* Next state on the given character, if any, or zero */
+  [[nodiscard]] auto next(std::uint32_t from, unsigned char c) const
+      -> std::uint32_t;
+
+  std::vector<entry_t> entries;
+
+  /* The initial state, i.e., the empty prefix, is the first one */
+  std::vector<state> states = std::vector<state>(1);
+
+  /* Transitions between states, by source state and character */
+  llvm::DenseMap<std::uint64_t, std::uint32_t> transitions;
+
+  /* Patterns without a literal, which must be tried on every name */
+  std::vector<std::size_t> unfiltered;
+};
+
+}  // end of namespace cclyzer
+
 auto preprocess_signatures(const boost::filesystem::path &signatures_path)
-    -> std::vector<std::tuple<std::string, std::regex, llvm::json::Array>>;
+    -> cclyzer::SignatureList;
 
 void emit_signatures(
     cclyzer::ForwardingFactWriter &writer,
     const std::string &function_name,
     const llvm::json::Array &signatures);
+
+#endif /* SIGNATURES_H__ */
@@ -0,0 +1,93 @@
+#ifndef VALUE_TABLE_H__
+#define VALUE_TABLE_H__
+
+#include <llvm/ADT/STLFunctionalExtras.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/IR/Value.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace cclyzer {
+
+// Values of a module by refmode, for looking up the values that analysis
+// results refer to. Values are numbered in the order they were added, and
+// looked up by refmode in constant time. As with a map, the first value added
+// under a refmode is the one that is kept.
+class ValueTable {
+ public:
+  using id_type = std::uint32_t;
+
+  /* ID of refmodes without a value */
+  static constexpr id_type NO_ID = static_cast<id_type>(-1);
+
+  ValueTable() = default;
+
+  /* Movable, but non-copyable */
+  ValueTable(ValueTable &&) = default;
+  auto operator=(ValueTable &&) -> ValueTable & = default;
+  ValueTable(const ValueTable &) = delete;
+  auto operator=(const ValueTable &) -> ValueTable & = delete;
+
+  /* Add a value under the given refmode, unless it already has one. Returns
+   * whether the value was added. */
+  auto insert(llvm::StringRef refmode, const llvm::Value *value) -> bool;
+
+  /* Add all values of another table, in order */
+  void append(const ValueTable &other);
+
+  /* Remove the values with the given ID or later for which the predicate
+   * holds, renumbering the rest */
+  void eraseIf(
+      id_type first, llvm::function_ref<bool(const llvm::Value *)> pred);
+
+  /* ID of the value with the given refmode, or NO_ID */
+  [[nodiscard]] auto idOf(llvm::StringRef refmode) const -> id_type {
+    const auto entry = ids.find(refmode);
+    return entry == ids.end() ? NO_ID : entry->second;
+  }
+
+  /* Value with the given refmode, or nullptr */
+  [[nodiscard]] auto find(llvm::StringRef refmode) const
+      -> const llvm::Value * {
+    const id_type id = idOf(refmode);
+    return id == NO_ID ? nullptr : values[id];
+  }
+
+  [[nodiscard]] auto value(id_type id) const -> const llvm::Value * {
+    return values[id];
+  }
+
+  [[nodiscard]] auto refmode(id_type id) const -> llvm::StringRef {
+    return refmodes[id]->getKey();
+  }
+
+  [[nodiscard]] auto size() const -> id_type {
+    return static_cast<id_type>(values.size());
+  }
+
+  [[nodiscard]] auto empty() const -> bool { return values.empty(); }
+
+  void clear();
+
+  void swap(ValueTable &other) noexcept {
+    values.swap(other.values);
+    refmodes.swap(other.refmodes);
+    std::swap(ids, other.ids);
+  }
+
+ private:
+  /* Values, and the entries of their refmodes in ids, by ID */
+  std::vector<const llvm::Value *> values;
+  std::vector<llvm::StringMapEntry<id_type> *> refmodes;
+
+  /* IDs by refmode */
+  llvm::StringMap<id_type> ids;
+};
+
+}  // end of namespace cclyzer
+
+#endif /* VALUE_TABLE_H__ */
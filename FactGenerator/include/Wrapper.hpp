@@ -4,23 +4,39 @@
 #include <llvm/IR/Module.h>
 
 #include <boost/filesystem.hpp>
-#include <boost/flyweight.hpp>
 #include <string>
 #include <tuple>
 #include <unordered_map>
 #include <vector>
 
+#include "Compression.hpp"
 #include "ContextSensitivity.hpp"
+#include "ValueTable.hpp"
 
 namespace fs = boost::filesystem;
 
+namespace cclyzer {
+class FactSink;
+}
+
 // Return both the directory with the facts and the identifying information
-// generated for the pointers being analyzed.
+// generated for the pointers being analyzed. If the last argument is true, the
+// facts refer to interned symbols, see FactWriter.
 auto factgen_module(
     llvm::Module &,
     const fs::path &,
     const llvm::Optional<boost::filesystem::path> &,
+    const ContextSensitivity,
+    cclyzer::Compression = cclyzer::Compression::GZIP,
+    int = cclyzer::DEFAULT_COMPRESSION_LEVEL,
+    bool = false)
+    -> std::tuple<boost::filesystem::path, cclyzer::ValueTable>;
+
+// Hand the facts directly to the given sink instead of writing them to a
+// directory, and return the identifying information as above.
+auto factgen_module(
+    llvm::Module &,
+    cclyzer::FactSink &,
+    const llvm::Optional<boost::filesystem::path> &,
     const ContextSensitivity)
-    -> std::tuple<
-        boost::filesystem::path,
-        std::map<boost::flyweight<std::string>, const llvm::Value *>>;
+    -> cclyzer::ValueTable;
@@ -0,0 +1,35 @@
+#include "Compression.hpp"
+
+auto cclyzer::compression_levels(Compression compression) -> std::string {
+  switch (compression) {
+    case Compression::NONE:
+      return "any level";
+    case Compression::GZIP:
+      return std::to_string(DEFAULT_COMPRESSION_LEVEL) + " (the default) or " +
+             std::to_string(MIN_GZIP_COMPRESSION_LEVEL) + " to " +
+             std::to_string(MAX_GZIP_COMPRESSION_LEVEL);
+    case Compression::ZSTD:
+      return std::to_string(MIN_ZSTD_COMPRESSION_LEVEL) + " to " +
+             std::to_string(MAX_ZSTD_COMPRESSION_LEVEL) + " (" +
+             std::to_string(DEFAULT_COMPRESSION_LEVEL) + " is the default)";
+  }
+  return "";
+}
+
+auto cclyzer::operator>>(std::istream& in, Compression& compression)
+    -> std::istream& {
+  std::string token;
+  in >> token;
+
+  if (token == NONE_COMPRESSION_STRING) {
+    compression = Compression::NONE;
+  } else if (token == GZIP_COMPRESSION_STRING) {
+    compression = Compression::GZIP;
+  } else if (token == ZSTD_COMPRESSION_STRING) {
+    compression = Compression::ZSTD;
+  } else {
+    in.setstate(std::ios_base::failbit);
+  }
+
+  return in;
+}
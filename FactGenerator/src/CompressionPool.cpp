@@ -0,0 +1,66 @@
+#include "CompressionPool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+using cclyzer::CompressionPool;
+
+CompressionPool::CompressionPool(
+    std::size_t threads, std::size_t maxPendingBlocks)
+    : maxPendingBlocks(std::max<std::size_t>(maxPendingBlocks, 1)) {
+  workers.reserve(threads);
+  for (std::size_t i = 0; i < threads; i++) {
+    workers.emplace_back([this] { run(); });
+  }
+}
+
+CompressionPool::~CompressionPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  taskAdded.notify_all();
+
+  // Workers finish all remaining tasks before exiting
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+}
+
+void CompressionPool::acquireBlock() {
+  std::unique_lock<std::mutex> lock(mutex);
+  blockReleased.wait(lock, [this] { return pendingBlocks < maxPendingBlocks; });
+  pendingBlocks++;
+}
+
+void CompressionPool::releaseBlock() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    pendingBlocks--;
+  }
+  blockReleased.notify_one();
+}
+
+void CompressionPool::submit(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    tasks.push_back(std::move(task));
+  }
+  taskAdded.notify_one();
+}
+
+void CompressionPool::run() {
+  for (;;) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      taskAdded.wait(lock, [this] { return stopping || !tasks.empty(); });
+      if (tasks.empty()) {
+        return;
+      }
+      task = std::move(tasks.front());
+      tasks.pop_front();
+    }
+    task();
+  }
+}
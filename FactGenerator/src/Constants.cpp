@@ -25,7 +25,7 @@ auto FactGenerator::writeConstant(const llvm::Constant &c)
   // Record constant entity with its type
   writeFact(pred::constant::id, id);
   writeFact(pred::constant::type, id, recordType(c.getType()));
-  result_map_.insert({boost::flyweight<std::string>(id), &c});
+  value_table_.insert(id, &c);
 
   // Record containing function
   const llvm::Function *containing_function = functionContext();
@@ -43,7 +43,7 @@ auto FactGenerator::writeConstant(const llvm::Constant &c)
 
   writeFact(pred::constant::value, id, val);
   writeFact(pred::constant::hash, id, hash_code);
-  result_map_.insert({boost::flyweight<std::string>(val), &c});
+  value_table_.insert(val, &c);
 
   if (isa<ConstantPointerNull>(c)) {
     writeFact(pred::nullptr_constant::id, id);
@@ -1,11 +1,11 @@
 #ifndef CONTEXT_MANAGER_HPP_
 #define CONTEXT_MANAGER_HPP_
 
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/IR/Function.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Value.h>
 
-#include <map>
 #include <sstream>
 #include <utility>
 #include <vector>
@@ -13,6 +13,11 @@
 namespace cclyzer {
 // Class that encapsulates any state that the refmode engine needs
 class ContextManager {
+ public:
+  // Function-local numbers of unnamed values
+  using numbering_t = llvm::DenseMap<const llvm::Value*, unsigned>;
+
+ private:
   // Single context item
   struct Context {
     Context(const llvm::Value& v, std::string prefix)
@@ -28,7 +33,7 @@ class ContextManager {
     const llvm::Value* anchor;
 
     // Mapping numbers to unnamed values
-    std::map<const llvm::Value*, unsigned> numbering;
+    numbering_t numbering;
 
     std::string prefix;
 
@@ -68,6 +73,7 @@ class ContextManager {
     if (const auto* fctx = llvm::dyn_cast<llvm::Function>(&ctx)) {
       prefix = fctx->getName();
       instrIndex = 0;
+      constantIndex = 0;
       iFunctionCtx = contexts.size();
     } else if (const auto* bbctx = llvm::dyn_cast<llvm::BasicBlock>(&ctx)) {
       prefix = bbctx->getName();
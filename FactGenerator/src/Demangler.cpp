@@ -0,0 +1,39 @@
+#include "Demangler.hpp"
+
+#include <cxxabi.h>
+
+auto Demangler::demangle(llvm::StringRef name) -> std::string_view {
+  // Other names may still demangle as types, e.g. "f" as "float"
+  if (!is_itanium_encoding(name)) {
+    return {name.data(), name.size()};
+  }
+
+  const auto [entry, inserted] = demangled.try_emplace(name);
+  if (!inserted) {
+    stats.hits++;
+    return entry->second;
+  }
+  stats.misses++;
+
+  const auto start = std::chrono::steady_clock::now();
+
+  // The buffer is reallocated (or replaced) if it's too small, in which case
+  // the new one is returned. The key of the entry is null-terminated.
+  int status = -1;
+  char* result = abi::__cxa_demangle(
+      entry->getKeyData(), buffer.get(), &bufferSize, &status);
+  if (result != nullptr) {
+    buffer.release();
+    buffer.reset(result);
+  }
+  entry->second = status == 0 ? std::string(result) : name.str();
+
+  stats.time += std::chrono::steady_clock::now() - start;
+  return entry->second;
+}
+
+void Demangler::addDemangleCacheStats(const CacheStats& other) {
+  stats.hits += other.hits;
+  stats.misses += other.misses;
+  stats.time += other.time;
+}
@@ -0,0 +1,36 @@
+#include "FactBuffer.hpp"
+
+using cclyzer::FactBuffer;
+
+void FactBuffer::insert(
+    const Predicate &pred, const std::vector<std::string> &fields) {
+  facts.push_back({&pred, fieldEnds.size()});
+  for (const std::string &field : fields) {
+    data.append(field);
+    fieldEnds.push_back(data.size());
+  }
+}
+
+void FactBuffer::writeTo(FactWriter &writer) {
+  const std::string_view contents(data);
+
+  for (std::size_t i = 0; i < facts.size(); i++) {
+    const std::size_t first = facts[i].firstField;
+    const std::size_t last =
+        i + 1 < facts.size() ? facts[i + 1].firstField : fieldEnds.size();
+
+    row.clear();
+    std::size_t start = first == 0 ? 0 : fieldEnds[first - 1];
+    for (std::size_t field = first; field < last; field++) {
+      row.push_back(contents.substr(start, fieldEnds[field] - start));
+      start = fieldEnds[field];
+    }
+
+    writer.writeFields(*facts[i].pred, row);
+  }
+
+  // Release the memory, since the buffer isn't reused
+  facts = {};
+  fieldEnds = {};
+  data = {};
+}
@@ -0,0 +1,253 @@
+#include "FactCache.hpp"
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/LEB128.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/xxhash.h>
+
+#include <boost/filesystem/fstream.hpp>
+
+#include "PredicateGroups.hpp"
+
+using cclyzer::FactBuffer;
+using cclyzer::FactCache;
+namespace fs = boost::filesystem;
+
+// Start of every entry, to be bumped whenever their format changes
+static const std::string ENTRY_HEADER = "cclyzer-fact-cache 2";
+
+// Entries are sequences of unsigned LEB128 numbers, and of strings prefixed
+// by their length. The header is followed by a checksum of the rest of the
+// entry, so that corrupted entries are rejected.
+
+static void writeNumber(llvm::raw_ostream &out, std::size_t number) {
+  llvm::encodeULEB128(number, out);
+}
+
+static void writeString(llvm::raw_ostream &out, llvm::StringRef str) {
+  writeNumber(out, str.size());
+  out << str;
+}
+
+namespace {
+
+// Reader of entries, which fails on any out of bounds read
+struct entry_reader {
+  const char *pos;
+  const char *end;
+  bool ok = true;
+
+  auto number() -> std::size_t {
+    const char *error = nullptr;
+    unsigned length = 0;
+    const std::uint64_t value = llvm::decodeULEB128(
+        reinterpret_cast<const std::uint8_t *>(pos),
+        &length,
+        reinterpret_cast<const std::uint8_t *>(end),
+        &error);
+    ok = ok && error == nullptr;
+    pos += ok ? length : 0;
+    return ok ? static_cast<std::size_t>(value) : 0;
+  }
+
+  // Number of items that follow, each taking at least a byte
+  auto count() -> std::size_t {
+    const std::size_t items = number();
+    ok = ok && items <= static_cast<std::size_t>(end - pos);
+    return ok ? items : 0;
+  }
+
+  auto string() -> llvm::StringRef {
+    const std::size_t length = number();
+    ok = ok && length <= static_cast<std::size_t>(end - pos);
+    if (!ok) {
+      return {};
+    }
+    llvm::StringRef str(pos, length);
+    pos += length;
+    return str;
+  }
+};
+
+}  // namespace
+
+// Identity of the running build of the fact generator, as the size and
+// modification time of its executable
+static auto buildStamp() -> std::string {
+  const std::string exe = llvm::sys::fs::getMainExecutable(nullptr, nullptr);
+
+  llvm::sys::fs::file_status status;
+  if (exe.empty() || llvm::sys::fs::status(exe, status)) {
+    return "";
+  }
+  return exe + ":" + std::to_string(status.getSize()) + ":" +
+         std::to_string(llvm::sys::toTimeT(status.getLastModificationTime()));
+}
+
+FactCache::FactCache(fs::path directory)
+    : directory(std::move(directory)), build(buildStamp()) {
+  fs::create_directories(this->directory);
+
+  for (const auto *pred : predicates::predicates_reg) {
+    predicates.emplace(pred->getName(), pred);
+  }
+}
+
+auto FactCache::key_stream::key() -> std::string {
+  llvm::MD5::MD5Result result;
+  hasher.final(result);
+  return result.digest().str().str();
+}
+
+void FactCache::key_stream::write_impl(const char *ptr, std::size_t size) {
+  hasher.update(llvm::StringRef(ptr, size));
+  pos += size;
+}
+
+auto FactCache::entryPath(const std::string &key) const -> fs::path {
+  // Entries written by other builds never match, since they may have
+  // generated different facts
+  key_stream stream;
+  stream << build << '\0' << key;
+  const std::string name = stream.key();
+
+  // Spread entries over subdirectories, to keep directories small
+  return directory / name.substr(0, 2) / name.substr(2);
+}
+
+auto FactCache::load(
+    const std::string &key, FactBuffer &facts, std::vector<std::string> &types)
+    -> bool {
+  auto contents = llvm::MemoryBuffer::getFile(
+      entryPath(key).string(), /*IsText=*/false, /*RequiresNullTerminator=*/
+      false);
+  if (!contents) {
+    missCount++;
+    return false;
+  }
+
+  entry_reader in{contents.get()->getBufferStart(),
+                  contents.get()->getBufferEnd()};
+  in.ok = in.string() == ENTRY_HEADER;
+  const std::uint64_t checksum = in.number();
+  const llvm::StringRef rest(in.pos, static_cast<std::size_t>(in.end - in.pos));
+  in.ok = in.ok && checksum == llvm::xxHash64(rest);
+
+  // Refmodes of types
+  types.resize(in.count());
+  for (std::size_t i = 0; in.ok && i < types.size(); i++) {
+    types[i] = in.string().str();
+  }
+
+  // Predicates of the facts below
+  std::vector<const Predicate *> preds(in.count());
+  for (std::size_t i = 0; in.ok && i < preds.size(); i++) {
+    const auto pred = predicates.find(in.string().str());
+    in.ok = in.ok && pred != predicates.end();
+    preds[i] = in.ok ? pred->second : nullptr;
+  }
+
+  // Facts, by predicate and number of fields
+  facts.facts.resize(in.count());
+  std::size_t fields = 0;
+  for (std::size_t i = 0; in.ok && i < facts.facts.size(); i++) {
+    const std::size_t pred = in.number();
+    in.ok = in.ok && pred < preds.size();
+    facts.facts[i] = {in.ok ? preds[pred] : nullptr, fields};
+    fields += in.number();
+  }
+
+  // Lengths of fields, and their contents
+  in.ok = in.ok && fields <= static_cast<std::size_t>(in.end - in.pos);
+  facts.fieldEnds.resize(in.ok ? fields : 0);
+  std::size_t end = 0;
+  for (std::size_t i = 0; in.ok && i < fields; i++) {
+    end += in.number();
+    facts.fieldEnds[i] = end;
+  }
+  const llvm::StringRef data = in.string();
+  in.ok = in.ok && data.size() == end && in.pos == in.end;
+
+  if (!in.ok) {
+    FactBuffer none;
+    facts.swap(none);
+    types.clear();
+    missCount++;
+    return false;
+  }
+
+  facts.data.assign(data.data(), data.size());
+  hitCount++;
+  return true;
+}
+
+void FactCache::store(
+    const std::string &key,
+    const FactBuffer &facts,
+    const std::vector<std::string> &types) {
+  std::string body;
+  llvm::raw_string_ostream out(body);
+
+  writeNumber(out, types.size());
+  for (const std::string &type : types) {
+    writeString(out, type);
+  }
+
+  // Number the predicates of the facts
+  llvm::DenseMap<const Predicate *, std::size_t> preds;
+  for (const auto &fact : facts.facts) {
+    preds.try_emplace(fact.pred, preds.size());
+  }
+  std::vector<const Predicate *> predsByNumber(preds.size());
+  for (const auto &[pred, number] : preds) {
+    predsByNumber[number] = pred;
+  }
+  writeNumber(out, predsByNumber.size());
+  for (const auto *pred : predsByNumber) {
+    writeString(out, pred->getName());
+  }
+
+  writeNumber(out, facts.facts.size());
+  for (std::size_t i = 0; i < facts.facts.size(); i++) {
+    const std::size_t last = i + 1 < facts.facts.size()
+                                 ? facts.facts[i + 1].firstField
+                                 : facts.fieldEnds.size();
+    writeNumber(out, preds[facts.facts[i].pred]);
+    writeNumber(out, last - facts.facts[i].firstField);
+  }
+
+  std::size_t start = 0;
+  for (const std::size_t end : facts.fieldEnds) {
+    writeNumber(out, end - start);
+    start = end;
+  }
+  writeString(out, facts.data);
+  out.flush();
+
+  std::string contents;
+  llvm::raw_string_ostream entry(contents);
+  writeString(entry, ENTRY_HEADER);
+  llvm::encodeULEB128(llvm::xxHash64(body), entry);
+  entry << body;
+  entry.flush();
+
+  // Write a temporary file next to the entry, then move it in place
+  const fs::path path = entryPath(key);
+  boost::system::error_code err;
+  fs::create_directories(path.parent_path(), err);
+
+  const fs::path temp = fs::unique_path(path.string() + ".%%%%-%%%%-%%%%");
+  {
+    fs::ofstream file(temp, std::ios::binary);
+    file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    if (file.flush()) {
+      file.close();
+      fs::rename(temp, path, err);
+      if (!err) {
+        return;
+      }
+    }
+  }
+  fs::remove(temp, err);
+}
@@ -1,40 +1,77 @@
 #include "FactGenerator.hpp"
 
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/SmallPtrSet.h>
 #include <llvm/IR/CFG.h>
 #include <llvm/IR/Constants.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Metadata.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Operator.h>
+#include <llvm/Support/Error.h>
 
+#include <algorithm>
+#include <memory>
 #include <regex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "ContextSensitivity.hpp"
+#include "FactBuffer.hpp"
+#include "FactCache.hpp"
 #include "InstructionVisitor.hpp"
+#include "MalformedModule.hpp"
+#include "OrderedJobs.hpp"
 #include "PredicateGroups.hpp"
 #include "Signatures.hpp"
+#include "TypeAccumulator.hpp"
 
 using cclyzer::FactGenerator;
 using llvm::cast;
 using llvm::isa;
 namespace pred = cclyzer::predicates;
 
-auto FactGenerator::getInstance(FactWriter &writer) -> FactGenerator & {
-  static FactGenerator this_instance(writer);
-  return this_instance;
+auto FactGenerator::processModule(
+    const llvm::Module &Mod,
+    const std::string &path,
+    const llvm::Optional<boost::filesystem::path> &signatures,
+    const ContextSensitivity &sensitivity,
+    std::size_t threads)
+    -> ValueTable {
+  if (!Mod.isMaterialized()) {
+    malformedModule("function bodies aren't loaded");
+  }
+  return processModule(Mod, nullptr, path, signatures, sensitivity, threads);
+}
+
+auto FactGenerator::processLazyModule(
+    llvm::Module &Mod,
+    const std::string &path,
+    const llvm::Optional<boost::filesystem::path> &signatures,
+    const ContextSensitivity &sensitivity) -> ValueTable {
+  return processModule(Mod, &Mod, path, signatures, sensitivity, 0);
 }
 
 auto FactGenerator::processModule(
     const llvm::Module &Mod,
+    llvm::Module *lazy,
     const std::string &path,
     const llvm::Optional<boost::filesystem::path> &signatures,
-    const ContextSensitivity &sensitivity)
-    -> std::map<boost::flyweight<std::string>, const llvm::Value *> {
+    const ContextSensitivity &sensitivity,
+    std::size_t threads) -> ValueTable {
   InstructionVisitor iv(*this, Mod);
   ModuleContext mc(*this, Mod, path);
 
+  // Forget about previous modules
+  value_table_.clear();
+  variables.clear();
+  types.clear();
+  clearDemangled();
+
   // Process points-to signatures
-  std::vector<std::tuple<std::string, std::regex, llvm::json::Array>>
-      functions_with_signatures;
+  signature_list_t functions_with_signatures;
   if (signatures.hasValue()) {
     functions_with_signatures = processSignatures(signatures.getValue());
   }
@@ -58,122 +95,542 @@ auto FactGenerator::processModule(
       context_sensitivity_to_string(sensitivity));
 
   // iterating over functions in a module
-  for (const auto &func : Mod) {
-    Context c(*this, func);
-    refmode_t funcref = refmode<llvm::Function>(func);
-
-    // Save the results for building the CPG
-    result_map_.insert({boost::flyweight<std::string>(funcref), &func});
-
-    // Process function and record its various attributes, but do
-    // not examine its body
-    writeFunction(func, funcref);
-
-    // Skip emitting facts about the body if the function has a signature
-    bool matched = false;
-    for (const auto &[regex_str, regex, sigs] : functions_with_signatures) {
-      const auto mangled_name = func.getName().str();
-      auto name = mangled_name;
-      if (is_itanium_encoding(name)) {
-        name = demangle(name);
-      }
-      if (std::regex_search(name, regex)) {
-        emitSignatures(mangled_name, sigs);
-        matched = true;
+  if (lazy != nullptr) {
+    for (auto &func : *lazy) {
+      if (func.isMaterializable()) {
+        processLazyFunction(func, iv, functions_with_signatures);
+      } else {
+        processFunction(func, iv, functions_with_signatures);
       }
     }
-    if (matched) {
-      continue;
+  } else if (threads == 0 && cache == nullptr) {
+    for (const auto &func : Mod) {
+      processFunction(func, iv, functions_with_signatures);
     }
+  } else {
+    processFunctionJobs(Mod, path, functions_with_signatures, threads);
+  }
 
-    // Previous instruction
-    const llvm::Instruction *prev_instr = nullptr;
-    refmode_t prev_iref;
+  return std::move(value_table_);
+}
 
-    // iterating over basic blocks in a function
-    for (const auto &bb : func) {
-      Context c(*this, bb);
-      refmode_t bb_ref = refmode<llvm::BasicBlock>(bb);
+void FactGenerator::processFunction(
+    const llvm::Function &func,
+    InstructionVisitor &iv,
+    const signature_list_t &functions_with_signatures) {
+  Context c(*this, func);
+  refmode_t funcref = refmode<llvm::Function>(func);
+
+  // Save the results for building the CPG
+  value_table_.insert(funcref, &func);
+
+  // Process function and record its various attributes, but do
+  // not examine its body
+  writeFunction(func, funcref);
+
+  // Skip emitting facts about the body if the function has a signature
+  bool matched = false;
+  if (!functions_with_signatures.empty()) {
+    const auto mangled_name = func.getName().str();
+    const std::string name(demangle(mangled_name));
+    for (const auto *sigs : functions_with_signatures.matching(name)) {
+      emitSignatures(mangled_name, *sigs);
+      matched = true;
+    }
+  }
+  if (matched) {
+    // Still record the parameters, which belong to this function
+    writeLocalVariables();
+    return;
+  }
+
+  // Previous instruction
+  const llvm::Instruction *prev_instr = nullptr;
+  refmode_t prev_iref;
+
+  // iterating over basic blocks in a function
+  for (const auto &bb : func) {
+    Context c(*this, bb);
+    refmode_view_t bb_ref = refmodeView<llvm::BasicBlock>(bb);
+
+    // Record basic block entry as a label
+    writeFact(pred::variable::id, bb_ref);
+    writeFact(pred::variable::type, bb_ref, "label");
+    writeFact(pred::variable::in_func, bb_ref, "@" + func.getName().str());
+
+    // Record variable name part
+    size_t idx = bb_ref.find_last_of("%!");
+    refmode_view_t bb_var_name = bb_ref.substr(idx);
+    writeFact(pred::variable::name, bb_ref, bb_var_name);
+
+    // Record basic block predecessors
+    for (llvm::const_pred_iterator pi = pred_begin(&bb),
+                                   pi_end = pred_end(&bb);
+         pi != pi_end;
+         ++pi) {
+      refmode_view_t pred_bb = refmodeView<llvm::BasicBlock>(**pi);
+      writeFact(pred::block::predecessor, bb_ref, pred_bb);
+    }
+
+    // iterating over basic block instructions
+    for (const auto &instr : bb) {
+      Context c(*this, instr);
+
+      // Compute instruction refmode
+      const refmode_t iref = refmode<llvm::Instruction>(instr);
+
+      // Save instructions for the CPG
+      value_table_.insert(iref, &instr);
+
+      // Record instruction target variable if such exists
+      if (!instr.getType()->isVoidTy()) {
+        refmode_view_t target_var = refmodeView<llvm::Value>(instr);
+
+        writeFact(pred::instr::assigns_to, iref, target_var);
+        recordVariable(instr);
 
-      // Record basic block entry as a label
-      writeFact(pred::variable::id, bb_ref);
-      writeFact(pred::variable::type, bb_ref, "label");
-      writeFact(pred::variable::in_func, bb_ref, "@" + func.getName().str());
+        // Save variables for the CPG
+        value_table_.insert(target_var, &instr);
+      }
+
+      // Record successor instruction
+      if (prev_instr != nullptr) {
+        writeFact(pred::instr::successor, prev_iref, iref);
+      }
+
+      // Store the refmode of this instruction for next iteration
+      prev_iref = iref;
+      prev_instr = &instr;
 
-      // Record variable name part
-      size_t idx = bb_ref.find_last_of("%!");
-      std::string bb_var_name = bb_ref.substr(idx);
-      writeFact(pred::variable::name, bb_ref, bb_var_name);
+      // Record instruction's container function
+      writeFact(pred::instr::func, iref, funcref);
 
-      // Record basic block predecessors
-      for (llvm::const_pred_iterator pi = pred_begin(&bb),
-                                     pi_end = pred_end(&bb);
-           pi != pi_end;
-           ++pi) {
-        refmode_t pred_bb = refmode<llvm::BasicBlock>(**pi);
-        writeFact(pred::block::predecessor, bb_ref, pred_bb);
+      // Record instruction's basic block entry (label)
+      const llvm::BasicBlock *bb_entry = instr.getParent();
+      refmode_view_t bb_entry_id = refmodeView<llvm::BasicBlock>(*bb_entry);
+      writeFact(pred::instr::bb_entry, iref, bb_entry_id);
+
+      // Visit instruction
+      iv.visit(const_cast<llvm::Instruction &>(instr));
+
+      // Get debug location if available
+      if (const llvm::DebugLoc &location = instr.getDebugLoc()) {
+        unsigned line = location.getLine();
+        unsigned column = location.getCol();
+
+        writeFact(pred::instr::pos, iref, line, column);
       }
+    }
+  }
+
+  writeLocalVariables();
+}
+
+void FactGenerator::processLazyFunction(
+    llvm::Function &func,
+    InstructionVisitor &iv,
+    const signature_list_t &functions_with_signatures) {
+  if (llvm::Error err = func.materialize()) {
+    malformedModule(
+        "can't load the body of @" + func.getName().str() + ": " +
+        llvm::toString(std::move(err)));
+  }
 
-      // iterating over basic block instructions
-      for (const auto &instr : bb) {
-        Context c(*this, instr);
+  // Values of this function are numbered after the values so far
+  const ValueTable::id_type first = value_table_.size();
 
-        // Compute instruction refmode
-        const refmode_t iref = refmode<llvm::Instruction>(instr);
+  processFunction(func, iv, functions_with_signatures);
+
+  // Other functions may refer to blocks whose address is taken, so keep the
+  // body around in that case
+  const bool release = llvm::none_of(
+      func, [](const llvm::BasicBlock &bb) { return bb.hasAddressTaken(); });
+
+  // Drop the instructions of a released body from the results
+  if (release) {
+    value_table_.eraseIf(first, [](const llvm::Value *value) {
+      return isa<llvm::Instruction>(value);
+    });
+    func.deleteBody();
+  }
+}
+
+// Create the constants that printing the given constant would create lazily
+static void createPrintedConstants(
+    const llvm::Constant &c,
+    llvm::SmallPtrSetImpl<const llvm::Constant *> &visited) {
+  // Global values are printed by name
+  if (isa<llvm::GlobalValue>(c) || !visited.insert(&c).second) {
+    return;
+  }
+
+  if (const auto *data = llvm::dyn_cast<llvm::ConstantDataSequential>(&c)) {
+    for (unsigned i = 0; i < data->getNumElements(); i++) {
+      data->getElementAsConstant(i);
+    }
+  }
+
+  for (const llvm::Use &op : c.operands()) {
+    createPrintedConstants(*cast<llvm::Constant>(op.get()), visited);
+  }
+}
 
-        // Save instructions for the CPG
-        result_map_.insert({boost::flyweight<std::string>(iref), &instr});
+// Worker threads only read the module, but some of the LLVM API they use
+// lazily creates arguments and constants, i.e., modifies the module and its
+// context. Create all of those up front.
+static void prepareForConcurrentReads(const llvm::Module &Mod) {
+  llvm::SmallPtrSet<const llvm::Constant *, 32> visited;
+
+  // Cache keys print the initializers of global variables
+  for (const auto &global : Mod.globals()) {
+    if (global.hasInitializer()) {
+      createPrintedConstants(*global.getInitializer(), visited);
+    }
+  }
+
+  for (const auto &func : Mod) {
+    func.arg_begin();
+
+    for (const auto &instr : llvm::instructions(func)) {
+      if (const auto *svi = llvm::dyn_cast<llvm::ShuffleVectorInst>(&instr)) {
+        createPrintedConstants(*svi->getShuffleMaskForBitcode(), visited);
+      }
+
+      for (const llvm::Use &op : instr.operands()) {
+        const llvm::Value *val = op.get();
+        if (const auto *md = llvm::dyn_cast<llvm::MetadataAsValue>(val)) {
+          if (const auto *cmd =
+                  llvm::dyn_cast<llvm::ConstantAsMetadata>(md->getMetadata())) {
+            val = cmd->getValue();
+          }
+        }
+        if (const auto *c = llvm::dyn_cast<llvm::Constant>(val)) {
+          createPrintedConstants(*c, visited);
+        }
+      }
+    }
+  }
+}
+
+void FactGenerator::processFunctionJobs(
+    const llvm::Module &Mod,
+    const std::string &path,
+    const signature_list_t &signatures,
+    std::size_t threads) {
+  if (threads > 0) {
+    prepareForConcurrentReads(Mod);
+  }
 
-        // Record instruction target variable if such exists
-        if (!instr.getType()->isVoidTy()) {
-          refmode_t target_var = refmode<llvm::Value>(instr);
+  std::vector<const llvm::Function *> functions;
+  for (const auto &func : Mod) {
+    functions.push_back(&func);
+  }
 
-          writeFact(pred::instr::assigns_to, iref, target_var);
-          recordVariable(target_var, instr.getType());
+  // Each worker has its own fact generator, with its own refmode context,
+  // whose facts are buffered rather than written
+  struct worker {
+    worker(const llvm::Module &Mod, const std::string &path)
+        : writer(buffer), gen(writer), iv(gen, Mod), mc(gen, Mod, path) {}
+
+    FactBuffer buffer;
+    FactWriter writer;
+    FactGenerator gen;
+    InstructionVisitor iv;
+    ModuleContext mc;
+  };
+  std::vector<std::unique_ptr<worker>> workers;
+  for (std::size_t t = 0; t < std::max<std::size_t>(threads, 1); t++) {
+    workers.push_back(std::make_unique<worker>(Mod, path));
+  }
 
-          // Save variables for the CPG
-          result_map_.insert(
-              {boost::flyweight<std::string>(target_var), &instr});
+  // Output of a single function
+  struct job {
+    FactBuffer facts;
+    ValueTable results;
+    boost::unordered_set<const llvm::Type *> types;
+  };
+  std::vector<job> jobs(functions.size());
+
+  const std::string moduleKey =
+      cache != nullptr ? moduleCacheKey(Mod, path, signatures) : "";
+
+  run_ordered_jobs(
+      functions.size(),
+      threads,
+      MAX_PENDING_FUNCTIONS_PER_THREAD * threads,
+      [&](std::size_t thread, std::size_t i) {
+        worker &w = *workers[thread];
+        const llvm::Function &func = *functions[i];
+
+        std::string key;
+        std::vector<std::string> typeRefmodes;
+        if (cache != nullptr) {
+          key = w.gen.functionCacheKey(func, moduleKey);
+
+          if (cache->load(key, jobs[i].facts, typeRefmodes) &&
+              w.gen.findCachedTypes(func, typeRefmodes, jobs[i].types)) {
+            Context c(w.gen, func);
+            jobs[i].results.insert(
+                w.gen.refmode<llvm::Function>(func), &func);
+            return;
+          }
+          FactBuffer none;
+          jobs[i].facts.swap(none);
+          jobs[i].types.clear();
         }
 
-        // Record successor instruction
-        if (prev_instr != nullptr) {
-          writeFact(pred::instr::successor, prev_iref, iref);
+        w.gen.processFunction(func, w.iv, signatures);
+        jobs[i].facts.swap(w.buffer);
+        jobs[i].results.swap(w.gen.value_table_);
+        jobs[i].types.swap(w.gen.types);
+
+        if (cache != nullptr) {
+          typeRefmodes.clear();
+          for (const auto *type : jobs[i].types) {
+            typeRefmodes.emplace_back(w.gen.refmodeView<llvm::Type>(*type));
+          }
+          cache->store(key, jobs[i].facts, typeRefmodes);
         }
+      },
+      [&](std::size_t i) {
+        // Write the output of each function in order, as if processed serially
+        jobs[i].facts.writeTo(getWriter());
+        value_table_.append(jobs[i].results);
+        types.insert(jobs[i].types.begin(), jobs[i].types.end());
+        jobs[i].results.clear();
+        jobs[i].types.clear();
+      });
+
+  for (const auto &w : workers) {
+    addDemangleCacheStats(w->gen.demangleCacheStats());
+  }
+}
+
+// Add the type of the given value to the accumulator, along with the types of
+// constants it refers to
+static void accumulateTypes(
+    const llvm::Value &val,
+    cclyzer::llvm_utils::TypeAccumulator &accum,
+    llvm::SmallPtrSetImpl<const llvm::Constant *> &visited) {
+  accum.visitType(val.getType());
+
+  if (const auto *md = llvm::dyn_cast<llvm::MetadataAsValue>(&val)) {
+    if (const auto *vmd =
+            llvm::dyn_cast<llvm::ValueAsMetadata>(md->getMetadata())) {
+      accumulateTypes(*vmd->getValue(), accum, visited);
+    }
+    return;
+  }
+
+  const auto *c = llvm::dyn_cast<llvm::Constant>(&val);
+  if (c == nullptr || !visited.insert(c).second) {
+    return;
+  }
+
+  if (const auto *gv = llvm::dyn_cast<llvm::GlobalValue>(c)) {
+    accum.visitType(gv->getValueType());
+    return;
+  }
+
+  for (const llvm::Use &op : c->operands()) {
+    accumulateTypes(*op.get(), accum, visited);
+  }
+}
+
+// Add (a superset of) the types that processing the function would record to
+// the accumulator, i.e., those of its values and of the constants they refer to
+static void accumulateFunctionTypes(
+    const llvm::Function &func, cclyzer::llvm_utils::TypeAccumulator &accum) {
+  llvm::SmallPtrSet<const llvm::Constant *, 32> visited;
+
+  accumulateTypes(func, accum, visited);
+  accum.visitType(func.getFunctionType());
+  if (func.hasPersonalityFn()) {
+    accumulateTypes(*func.getPersonalityFn(), accum, visited);
+  }
+  for (const auto &arg : func.args()) {
+    accum.visitType(arg.getType());
+  }
+
+  for (const auto &instr : llvm::instructions(func)) {
+    accumulateTypes(instr, accum, visited);
+    for (const llvm::Use &op : instr.operands()) {
+      accumulateTypes(*op.get(), accum, visited);
+    }
+
+    if (const auto *alloca = llvm::dyn_cast<llvm::AllocaInst>(&instr)) {
+      accum.visitType(alloca->getAllocatedType());
+    } else if (const auto *gep = llvm::dyn_cast<llvm::GetElementPtrInst>(
+                   &instr)) {
+      accum.visitType(gep->getSourceElementType());
+    } else if (const auto *call = llvm::dyn_cast<llvm::CallBase>(&instr)) {
+      accum.visitType(call->getFunctionType());
+    } else if (const auto *svi = llvm::dyn_cast<llvm::ShuffleVectorInst>(
+                   &instr)) {
+      accumulateTypes(*svi->getShuffleMaskForBitcode(), accum, visited);
+    }
+  }
+}
+
+// Add the global variables that the given value refers to, along with those
+// that their initializers refer to, in the order found
+static void collectGlobals(
+    const llvm::Value &val,
+    llvm::SmallVectorImpl<const llvm::GlobalVariable *> &globals,
+    llvm::SmallPtrSetImpl<const llvm::Constant *> &visited) {
+  if (const auto *md = llvm::dyn_cast<llvm::MetadataAsValue>(&val)) {
+    if (const auto *vmd =
+            llvm::dyn_cast<llvm::ValueAsMetadata>(md->getMetadata())) {
+      collectGlobals(*vmd->getValue(), globals, visited);
+    }
+    return;
+  }
+
+  const auto *c = llvm::dyn_cast<llvm::Constant>(&val);
+  if (c == nullptr || !visited.insert(c).second) {
+    return;
+  }
+
+  if (const auto *gv = llvm::dyn_cast<llvm::GlobalVariable>(c)) {
+    globals.push_back(gv);
+    if (gv->hasInitializer()) {
+      collectGlobals(*gv->getInitializer(), globals, visited);
+    }
+    return;
+  }
 
-        // Store the refmode of this instruction for next iteration
-        prev_iref = iref;
-        prev_instr = &instr;
+  if (const auto *alias = llvm::dyn_cast<llvm::GlobalAlias>(c)) {
+    collectGlobals(*alias->getAliasee(), globals, visited);
+    return;
+  }
 
-        // Record instruction's container function
-        writeFact(pred::instr::func, iref, funcref);
+  // Functions have keys of their own
+  if (isa<llvm::GlobalValue>(c)) {
+    return;
+  }
 
-        // Record instruction's basic block entry (label)
-        const llvm::BasicBlock *bb_entry = instr.getParent();
-        refmode_t bb_entry_id = refmode<llvm::BasicBlock>(*bb_entry);
-        writeFact(pred::instr::bb_entry, iref, bb_entry_id);
+  for (const llvm::Use &op : c->operands()) {
+    collectGlobals(*op.get(), globals, visited);
+  }
+}
 
-        // Visit instruction
-        iv.visit(const_cast<llvm::Instruction &>(instr));
+auto FactGenerator::moduleCacheKey(
+    const llvm::Module &Mod,
+    const std::string &path,
+    const signature_list_t &signatures) -> std::string {
+  FactCache::key_stream key;
 
-        // Get debug location if available
-        if (const llvm::DebugLoc &location = instr.getDebugLoc()) {
-          unsigned line = location.getLine();
-          unsigned column = location.getCol();
+  // Refmodes start with the module path
+  key << path << '\0' << Mod.getTargetTriple() << '\0'
+      << Mod.getDataLayoutStr() << '\0';
 
-          writeFact(pred::instr::pos, iref, line, column);
+  // Functions with signatures get their facts from the signatures instead
+  for (const auto &[regex_str, regex, sigs] : signatures) {
+    key << regex_str << '\0' << llvm::json::Value(llvm::json::Array(sigs))
+        << '\0';
+  }
+
+  return key.key();
+}
+
+auto FactGenerator::functionCacheKey(
+    const llvm::Function &func, const std::string &moduleKey) -> std::string {
+  FactCache::key_stream key;
+  key << moduleKey << '\0';
+
+  // The printed function refers to global values and metadata with the same
+  // names and numbers as refmodes
+  print(func, key);
+
+  // Metadata and the function attributes of call sites are only printed by
+  // reference, so add their contents
+  llvm::SmallPtrSet<const llvm::Metadata *, 32> metadata;
+  llvm::SmallVector<std::pair<unsigned, llvm::MDNode *>, 4> attached;
+
+  for (const auto &instr : llvm::instructions(func)) {
+    instr.getAllMetadata(attached);
+    for (const auto &[kind, node] : attached) {
+      if (metadata.insert(node).second) {
+        print(*node, key);
+        key << '\n';
+      }
+    }
+
+    for (const llvm::Use &op : instr.operands()) {
+      if (const auto *md = llvm::dyn_cast<llvm::MetadataAsValue>(op.get())) {
+        if (metadata.insert(md->getMetadata()).second) {
+          print(*md->getMetadata(), key);
+          key << '\n';
         }
       }
     }
 
-    writeLocalVariables();
+    if (const auto *call = llvm::dyn_cast<llvm::CallBase>(&instr)) {
+      key << call->getAttributes().getAsString(
+                 llvm::AttributeList::FunctionIndex)
+          << '\n';
+    }
   }
 
-  return this->result_map_;
+  // Global variables are also printed by name, so add their initializers
+  llvm::SmallVector<const llvm::GlobalVariable *, 16> globals;
+  llvm::SmallPtrSet<const llvm::Constant *, 32> visited;
+  if (func.hasPersonalityFn()) {
+    collectGlobals(*func.getPersonalityFn(), globals, visited);
+  }
+  for (const auto &instr : llvm::instructions(func)) {
+    for (const llvm::Use &op : instr.operands()) {
+      collectGlobals(*op.get(), globals, visited);
+    }
+  }
+  for (const auto *global : globals) {
+    print(*global, key);
+    key << '\n';
+  }
+
+  // As are named struct types, so add their bodies, in a stable order
+  llvm_utils::TypeAccumulator accum;
+  accumulateFunctionTypes(func, accum);
+  std::vector<std::string> structs;
+  for (const auto *type : accum) {
+    const auto *s_ty = llvm::dyn_cast<llvm::StructType>(type);
+    if (s_ty != nullptr && s_ty->hasName()) {
+      llvm::raw_string_ostream rso(structs.emplace_back());
+      type->print(rso);
+    }
+  }
+  std::sort(structs.begin(), structs.end());
+  for (const auto &body : structs) {
+    key << body << '\n';
+  }
+
+  return key.key();
+}
+
+auto FactGenerator::findCachedTypes(
+    const llvm::Function &func,
+    const std::vector<std::string> &refmodes,
+    boost::unordered_set<const llvm::Type *> &found) -> bool {
+  llvm_utils::TypeAccumulator accum;
+  accumulateFunctionTypes(func, accum);
+
+  std::unordered_map<refmode_view_t, const llvm::Type *> byRefmode;
+  for (const auto *type : accum) {
+    byRefmode.emplace(refmodeView<llvm::Type>(*type), type);
+  }
+
+  for (const std::string &refmode : refmodes) {
+    const auto it = byRefmode.find(refmode);
+    if (it == byRefmode.end()) {
+      return false;
+    }
+    found.insert(it->second);
+  }
+  return true;
 }
 
 auto FactGenerator::processSignatures(const boost::filesystem::path &signatures)
-    -> std::vector<std::tuple<std::string, std::regex, llvm::json::Array>> {
+    -> signature_list_t {
   return preprocess_signatures(signatures);
 }
 
@@ -1,6 +1,9 @@
 #include "FactWriter.hpp"
 
 #include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <limits>
 
 #include "PredicateGroups.hpp"
 
@@ -12,12 +15,6 @@ using cclyzer::FactWriter;
 
 using pred::pred_t;
 
-//-------------------------------------------------------------------
-// Constant Definitions
-//-------------------------------------------------------------------
-
-const std::string FactWriter::FILE_EXTENSION = ".csv.gz";
-
 //-------------------------------------------------------------------
 // Delegating Constructors
 //-------------------------------------------------------------------
@@ -26,11 +23,34 @@ FactWriter::FactWriter(
     const Registry<pred_t>& registry,
     path outputDirectory,
     string delimiter,
+    Compression compression,
+    int compressionLevel,
+    std::size_t maxOpenFiles,
+    std::size_t compressionThreads,
+    bool deduplicate,
+    bool internSymbols,
     BOOST_IOS::openmode mode)
     : delim(std::move(delimiter)),
       outdir(std::move(outputDirectory)),
+      compression(compression),
+      compressionLevel(compressionLevel),
+      maxOpenFiles(std::max<std::size_t>(maxOpenFiles, 1)),
+      deduplicate(deduplicate),
       mode(mode) {
-  // Initialize all CSV writers
+  if (compressionThreads > 0) {
+    pool = std::make_unique<CompressionPool>(
+        compressionThreads, MAX_PENDING_BLOCKS_PER_THREAD * compressionThreads);
+  }
+
+  if (internSymbols) {
+    path file = outdir / SYMBOLS_FILE;
+    file += compression_extension(compression);
+    create_directory(file.parent_path());
+    symbols = std::make_unique<csv_writer>(
+        file, delim, compression, compressionLevel, mode, pool.get());
+  }
+
+  // Register all predicates; their CSV writers are opened lazily
   init_writers(registry);
 }
 
@@ -40,9 +60,41 @@ FactWriter::FactWriter(const Registry<pred_t>& registry, path outputDirectory)
 FactWriter::FactWriter(const Registry<pred_t>& registry)
     : FactWriter(registry, fs::current_path()) {}
 
+FactWriter::FactWriter(FactSink& sink)
+    : delim("\t"),
+      compression(Compression::NONE),
+      compressionLevel(DEFAULT_COMPRESSION_LEVEL),
+      maxOpenFiles(0),
+      deduplicate(false),
+      mode(BOOST_IOS::out),
+      sink(&sink) {}
+
 FactWriter::~FactWriter() {
-  for (auto& [_, writer] : writers) {
-    delete writer;
+  // Best effort, for writers that weren't closed. Only close() reports errors.
+  try {
+    close();
+  } catch (...) {  // NOLINT(bugprone-empty-catch)
+  }
+}
+
+void FactWriter::close() {
+  // Create the files of predicates without any facts, so that they can still
+  // be loaded
+  for (std::size_t file = 0; file < files.size(); file++) {
+    if (!files[file].created) {
+      openWriter(file);
+    }
+  }
+
+  while (!openWriters.empty()) {
+    std::unique_ptr<csv_writer> writer =
+        std::move(files[openWriters.back()].writer);
+    openWriters.pop_back();
+    writer->close();
+  }
+
+  if (symbols) {
+    symbols->close();
   }
 }
 
@@ -50,26 +102,136 @@ FactWriter::~FactWriter() {
 // CSV Writers Management
 //-------------------------------------------------------------------
 
-auto FactWriter::getWriter(const pred_t& pred) -> csv_writer* {
-  using namespace boost::filesystem;
+auto FactWriter::addFile(const pred_t& pred) -> std::size_t {
+  // Use predicate index as key
+  const std::size_t key = pred.getIndex();
+
+  if (key >= fileIndex.size()) {
+    fileIndex.resize(key + 1, NO_FILE);
+  }
+
+  if (fileIndex[key] == NO_FILE) {
+    // Predicates may share a file, and must then share its writer
+    auto [it, inserted] = fileNames.emplace(pred.getName(), files.size());
+    if (inserted) {
+      files.emplace_back();
+      files.back().pred = &pred;
+      if (deduplicate) {
+        files.back().written = std::make_unique<written_records>();
+      }
+    }
+    fileIndex[key] = it->second;
+  }
 
-  // Use predicate name as key
-  const string& key = pred.getName();
+  return fileIndex[key];
+}
 
-  // Search for existing writer
-  map<string, csv_writer*>::iterator it = writers.find(key);
+auto FactWriter::openWriter(std::size_t file) -> csv_writer* {
+  using namespace boost::filesystem;
 
-  // Return existing writer
-  if (it != writers.end()) {
-    return it->second;
+  // Close least recently used writer, to stay within the limit
+  if (openWriters.size() >= maxOpenFiles) {
+    std::unique_ptr<csv_writer> writer =
+        std::move(files[openWriters.back()].writer);
+    openWriters.pop_back();
+    writer->close();
   }
 
+  writer_slot& slot = files[file];
+
   // Get filesystem path to CSV file
-  path file = getPath(pred);
-  create_directory(file.parent_path());
+  path csvfile = getPath(*slot.pred);
+
+  // Reopened files are appended to. Compressed files then consist of several
+  // concatenated streams, which both gzip and zstd readers accept.
+  BOOST_IOS::openmode openmode = mode;
+  if (slot.created) {
+    openmode = (mode & ~BOOST_IOS::trunc) | BOOST_IOS::app;
+  } else {
+    create_directory(csvfile.parent_path());
+  }
 
   // Create and return new writer
-  return writers[key] = new csv_writer(file, delim, mode);
+  slot.writer = std::make_unique<csv_writer>(
+      csvfile,
+      delim,
+      compression,
+      compressionLevel,
+      openmode,
+      pool.get(),
+      slot.written.get());
+  slot.created = true;
+  slot.lru = openWriters.insert(openWriters.begin(), file);
+
+  return slot.writer.get();
+}
+
+void FactWriter::writeFields(
+    const pred_t& pred, const std::vector<std::string_view>& row) {
+  if (sink == nullptr && !symbols) {
+    getWriter(pred)->writeRow(row);
+    return;
+  }
+
+  fields.resize(row.size());
+  for (std::size_t i = 0; i < row.size(); i++) {
+    fields[i].assign(row[i]);
+  }
+
+  if (sink != nullptr) {
+    sink->insert(pred, fields);
+  } else {
+    internFields(pred);
+  }
+}
+
+// Whether a field is an integer, which is cheaper to write as is than to
+// intern
+static auto is_integer(std::string_view field) -> bool {
+  constexpr std::size_t MAX_LENGTH = 20;
+  if (!field.empty() && field.front() == '-') {
+    field.remove_prefix(1);
+  }
+  return !field.empty() && field.size() <= MAX_LENGTH &&
+         std::all_of(field.begin(), field.end(), [](char c) {
+           return std::isdigit(static_cast<unsigned char>(c)) != 0;
+         });
+}
+
+void FactWriter::internFields(const pred_t& pred) {
+  internedFields.resize(fields.size());
+  for (std::size_t i = 0; i < fields.size(); i++) {
+    string& field = internedFields[i];
+    if (is_integer(fields[i])) {
+      field.assign(1, INTEGER_PREFIX);
+      field.append(fields[i]);
+    } else {
+      // Enough for the digits of any ID
+      char chars[std::numeric_limits<std::size_t>::digits10 + 1];  // NOLINT
+      auto result = std::to_chars(
+          std::begin(chars), std::end(chars), internSymbol(fields[i]));
+      field.assign(std::begin(chars), result.ptr);
+    }
+  }
+  getWriter(pred)->writeRow(internedFields);
+}
+
+auto FactWriter::internSymbol(const string& symbol) -> std::size_t {
+  auto [it, inserted] = symbolTable.try_emplace(symbol, symbolTable.size());
+  if (inserted) {
+    symbols->write(symbol);
+  }
+  return it->second;
+}
+
+auto FactWriter::getDuplicates() const -> std::map<string, std::size_t> {
+  std::map<string, std::size_t> duplicates;
+  for (const writer_slot& slot : files) {
+    if (slot.written) {
+      duplicates[slot.pred->getName()] = slot.written->duplicates;
+    }
+  }
+  return duplicates;
 }
 
 auto FactWriter::getPath(const pred_t& pred) -> fs::path {
@@ -82,16 +244,13 @@ auto FactWriter::getPath(const pred_t& pred) -> fs::path {
 
   // Add directory and extension
   fs::path path = outdir / basename;
-  path += FILE_EXTENSION;
+  path += compression_extension(compression);
 
   return path;
 }
 
 void FactWriter::init_writers(const Registry<pred_t>& registry) {
   for (const pred_t* pred : registry) {
-    getWriter(*pred);
+    addFile(*pred);
   }
-
-  // TODO: Consider closing streams and opening them lazily, so as
-  // not to exceed the maximum number of open file descriptors
 }
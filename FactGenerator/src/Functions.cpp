@@ -17,7 +17,7 @@ void FactGenerator::writeFunction(
   // Serialize function properties
   refmode_t visibility = refmode(func.getVisibility());
   refmode_t linkage = refmode(func.getLinkage());
-  refmode_t type_signature = recordType(func.getFunctionType());
+  refmode_view_t type_signature = recordType(func.getFunctionType());
 
   // Record function type signature
   writeFact(pred::func::ty, funcref, type_signature);
@@ -97,9 +97,9 @@ void FactGenerator::writeFunction(
     refmode_t var_id = refmode<llvm::Value>(*arg);
 
     // Save parameters for CPG
-    result_map_.insert({boost::flyweight<std::string>(var_id), arg});
+    value_table_.insert(var_id, arg);
 
     writeFact(pred::func::param, funcref, index++, var_id);
-    recordVariable(var_id, arg->getType());
+    recordVariable(*arg);
   }
 }
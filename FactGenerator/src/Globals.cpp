@@ -29,7 +29,7 @@ void FactGenerator::writeGlobalAlias(
   // Serialize alias properties
   refmode_t visibility = refmode(ga.getVisibility());
   refmode_t linkage = refmode(ga.getLinkage());
-  refmode_t alias_type = recordType(ga.getType());
+  refmode_view_t alias_type = recordType(ga.getType());
 
   // Record visibility
   if (!visibility.empty()) {
@@ -57,7 +57,7 @@ void FactGenerator::writeGlobalVar(
   // Record global variable entity
   writeFact(pred::global_var::id, id);
   writeFact(pred::global_var::name, id, name);
-  result_map_.insert({boost::flyweight<std::string>(id), &gv});
+  value_table_.insert(id, &gv);
 
   // Also record original pointer type
   recordType(gv.getType());
@@ -66,9 +66,9 @@ void FactGenerator::writeGlobalVar(
   refmode_t visibility = refmode(gv.getVisibility());
   refmode_t linkage = refmode(gv.getLinkage());
 #if LLVM_VERSION_MAJOR > 14
-  refmode_t var_type = recordType(gv.getType());
+  refmode_view_t var_type = recordType(gv.getType());
 #else
-  refmode_t var_type = recordType(gv.getType()->getElementType());
+  refmode_view_t var_type = recordType(gv.getType()->getElementType());
 #endif
   refmode_t thr_loc_mode = refmode(gv.getThreadLocalMode());
 
@@ -34,7 +34,6 @@ auto InstructionVisitor::recordInstruction(
 auto InstructionVisitor::recordValue(const llvm::Value *Val)
     -> cclyzer::refmode_t {
   refmode_t refmode;
-  const llvm::Type *type = Val->getType();
 
   if (const auto *c = dyn_cast<llvm::Constant>(Val)) {
     // Compute refmode for constant value.
@@ -53,7 +52,7 @@ auto InstructionVisitor::recordValue(const llvm::Value *Val)
     refmode = gen.refmode<llvm::Value>(*Val);
 
     // Record variable value
-    gen.recordVariable(refmode, type);
+    gen.recordVariable(*Val);
   }
 
   return refmode;
@@ -320,7 +319,7 @@ void InstructionVisitor::visitUnreachableInst(const llvm::UnreachableInst &I) {
 
 void InstructionVisitor::visitAllocaInst(const llvm::AllocaInst &AI) {
   refmode_t iref = recordInstruction(pred::alloca::instr, AI);
-  refmode_t type = gen.recordType(AI.getAllocatedType());
+  refmode_view_t type = gen.recordType(AI.getAllocatedType());
 
   gen.writeFact(pred::alloca::type, iref, type);
 
@@ -361,7 +360,7 @@ void InstructionVisitor::visitLoadInst(const llvm::LoadInst &LI) {
 
 void InstructionVisitor::visitVAArgInst(const llvm::VAArgInst &VI) {
   refmode_t iref = recordInstruction(pred::va_arg::instr, VI);
-  refmode_t type = gen.recordType(VI.getType());
+  refmode_view_t type = gen.recordType(VI.getType());
 
   gen.writeFact(pred::va_arg::type, iref, type);
   writeInstrOperand(pred::va_arg::va_list, iref, VI.getPointerOperand());
@@ -501,7 +500,7 @@ void InstructionVisitor::visitGetElementPtrInst(
 void InstructionVisitor::visitPHINode(const llvm::PHINode &PHI) {
   // <result> = phi <ty> [ <val0>, <label0>], ...
   refmode_t iref = recordInstruction(pred::phi::instr, PHI);
-  refmode_t type = gen.recordType(PHI.getType());
+  refmode_view_t type = gen.recordType(PHI.getType());
 
   // type
   gen.writeFact(pred::phi::type, iref, type);
@@ -544,7 +543,7 @@ void InstructionVisitor::visitInsertValueInst(
 
 void InstructionVisitor::visitLandingPadInst(const llvm::LandingPadInst &LI) {
   refmode_t iref = recordInstruction(pred::landingpad::instr, LI);
-  refmode_t type = gen.recordType(LI.getType());
+  refmode_view_t type = gen.recordType(LI.getType());
 
   gen.writeFact(pred::landingpad::type, iref, type);
 
@@ -4,24 +4,77 @@
 #include <llvm/IRReader/IRReader.h>
 #include <llvm/Support/SourceMgr.h>
 
+#include <sys/resource.h>
+
 #include <boost/filesystem.hpp>
+#include <chrono>
+#include <ios>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "ContextSensitivity.hpp"
+#include "Demangler.hpp"
+#include "FactBuffer.hpp"
+#include "FactCache.hpp"
 #include "FactGenerator.hpp"
 #include "FactWriter.hpp"
 #include "Factgen.hpp"
 #include "Options.hpp"
+#include "OrderedJobs.hpp"
 #include "ParseException.hpp"
+#include "RefmodeEngine.hpp"
 
 // Type aliases
 namespace fs = boost::filesystem;
 
+// Bound on the input files processed ahead of the ones written, per job
+static constexpr std::size_t MAX_PENDING_FILES_PER_JOB = 2;
+
 //--------------------------------------------------------------------------
 // Driver Fact-Generation Routine
 //--------------------------------------------------------------------------
 
+// Parse a single input file, and generate facts for it
+static void factgen_file(
+    cclyzer::FactGenerator &gen,
+    llvm::LLVMContext &context,
+    const fs::path &input_file,
+    const llvm::Optional<fs::path> &signatures,
+    const ContextSensitivity &context_sensitivity,
+    std::size_t function_threads,
+    bool lazy) {
+  llvm::SMDiagnostic err;
+
+  // Parse input file, leaving function bodies to be loaded on demand if lazy
+  std::unique_ptr<llvm::Module> module =
+      lazy ? llvm::getLazyIRFileModule(input_file.string(), err, context)
+           : llvm::parseIRFile(input_file.string(), err, context);
+
+  // Check if parsing succeeded
+  if (!module) {
+    throw ParseException(input_file);
+  }
+
+  // Canonicalize path
+  std::string real_path = fs::canonical(input_file).string();
+
+  // Generate facts for this module
+  if (lazy) {
+    gen.processLazyModule(*module, real_path, signatures, context_sensitivity);
+  } else {
+    gen.processModule(
+        *module, real_path, signatures, context_sensitivity, function_threads);
+  }
+
+  // Get data layout of this module
+  const llvm::DataLayout &layout = module->getDataLayout();
+
+  // Write types
+  gen.writeTypes(layout);
+}
+
 template <typename FileIt>
 void cclyzer::factgen(
     FileIt firstFile,
@@ -29,44 +82,151 @@ void cclyzer::factgen(
     const fs::path &outputDir,
     const llvm::Optional<fs::path> &signatures,
     const ContextSensitivity &context_sensitivity,
-    const std::string &delim) {
+    const std::string &delim,
+    Compression compression,
+    int compression_level,
+    std::size_t max_open_files,
+    std::size_t compression_threads,
+    std::size_t function_threads,
+    std::size_t jobs,
+    const llvm::Optional<fs::path> &fact_cache,
+    bool deduplicate,
+    bool intern_symbols,
+    bool lazy,
+    bool print_stats) {
+  using cclyzer::FactBuffer;
+  using cclyzer::FactCache;
   using cclyzer::FactGenerator;
   using cclyzer::FactWriter;
+  using cclyzer::RefmodeEngine;
   using cclyzer::predicates::predicates_reg;
 
-  llvm::LLVMContext context;
-  llvm::SMDiagnostic err;
-
   // Create fact writer
-  FactWriter writer(predicates_reg, outputDir, delim);
+  FactWriter writer(
+      predicates_reg,
+      outputDir,
+      delim,
+      compression,
+      compression_level,
+      max_open_files,
+      compression_threads,
+      deduplicate,
+      intern_symbols);
 
-  // Create CSV generator
-  FactGenerator &gen = FactGenerator::getInstance(writer);
+  // Create fact cache, shared by all fact generators
+  std::unique_ptr<FactCache> cache;
+  if (fact_cache.hasValue()) {
+    cache = std::make_unique<FactCache>(fact_cache.getValue());
+  }
+
+  RefmodeEngine::CacheStats value_stats;
+  RefmodeEngine::CacheStats type_stats;
+  Demangler::CacheStats demangle_stats;
 
-  // Loop over each input file
-  for (FileIt it = firstFile; it != endFile; ++it) {
-    const fs::path &input_file = *it;
+  if (jobs == 0) {
+    llvm::LLVMContext context;
 
-    // Parse input file
-    std::unique_ptr<llvm::Module> module =
-        llvm::parseIRFile(input_file.string(), err, context);
+    // Create CSV generator
+    FactGenerator gen(writer, cache.get());
 
-    // Check if parsing succeeded
-    if (!module) {
-      throw ParseException(input_file);
+    // Loop over each input file
+    for (FileIt it = firstFile; it != endFile; ++it) {
+      factgen_file(
+          gen,
+          context,
+          *it,
+          signatures,
+          context_sensitivity,
+          function_threads,
+          lazy);
     }
 
-    // Canonicalize path
-    std::string real_path = fs::canonical(input_file).string();
+    value_stats = gen.valueCacheStats();
+    type_stats = gen.typeCacheStats();
+    demangle_stats = gen.demangleCacheStats();
+  } else {
+    const std::vector<fs::path> files(firstFile, endFile);
+
+    // Facts of a single input file
+    struct module_facts {
+      FactBuffer facts;
+      RefmodeEngine::CacheStats value_stats;
+      RefmodeEngine::CacheStats type_stats;
+      Demangler::CacheStats demangle_stats;
+    };
+    std::vector<module_facts> modules(files.size());
+
+    // Each input file gets its own LLVM context and fact generator, so that
+    // nothing carries over between files processed by the same worker
+    run_ordered_jobs(
+        files.size(),
+        jobs,
+        MAX_PENDING_FILES_PER_JOB * jobs,
+        [&](std::size_t, std::size_t i) {
+          llvm::LLVMContext context;
+          FactWriter buffer_writer(modules[i].facts);
+          FactGenerator gen(buffer_writer, cache.get());
+
+          factgen_file(
+              gen,
+              context,
+              files[i],
+              signatures,
+              context_sensitivity,
+              function_threads,
+              lazy);
+
+          modules[i].value_stats = gen.valueCacheStats();
+          modules[i].type_stats = gen.typeCacheStats();
+          modules[i].demangle_stats = gen.demangleCacheStats();
+        },
+        [&](std::size_t i) {
+          // Write the facts of each input file in order
+          modules[i].facts.writeTo(writer);
+
+          value_stats.hits += modules[i].value_stats.hits;
+          value_stats.misses += modules[i].value_stats.misses;
+          type_stats.hits += modules[i].type_stats.hits;
+          type_stats.misses += modules[i].type_stats.misses;
+          demangle_stats.hits += modules[i].demangle_stats.hits;
+          demangle_stats.misses += modules[i].demangle_stats.misses;
+          demangle_stats.time += modules[i].demangle_stats.time;
+        });
+  }
+
+  writer.close();
 
-    // Generate facts for this module
-    gen.processModule(*module, real_path, signatures, context_sensitivity);
+  if (print_stats) {
+    std::cerr << "Refmode cache hits: " << value_stats.hits << " of "
+              << value_stats.hits + value_stats.misses << " (values), "
+              << type_stats.hits << " of "
+              << type_stats.hits + type_stats.misses << " (types)\n";
 
-    // Get data layout of this module
-    const llvm::DataLayout &layout = module->getDataLayout();
+    std::cerr << "Demangling cache hits: " << demangle_stats.hits << " of "
+              << demangle_stats.hits + demangle_stats.misses << " names ("
+              << std::chrono::duration_cast<std::chrono::milliseconds>(
+                     demangle_stats.time)
+                     .count()
+              << " ms demangling)\n";
 
-    // Write types
-    gen.writeTypes(layout);
+    if (cache) {
+      std::cerr << "Fact cache hits: " << cache->hits() << " of "
+                << cache->hits() + cache->misses() << " functions\n";
+    }
+
+    // Linux reports the maximum resident set size in kilobytes
+    struct rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+      std::cerr << "Peak memory: " << usage.ru_maxrss / 1024 << " MB\n";
+    }
+  }
+
+  // Report dropped duplicates
+  for (const auto &[name, duplicates] : writer.getDuplicates()) {
+    if (duplicates > 0) {
+      std::cerr << "Dropped " << duplicates << " duplicate facts of " << name
+                << "\n";
+    }
   }
 }
 
@@ -83,10 +243,24 @@ auto main(int argc, char *argv[]) -> int {
         options.output_dir(),
         options.get_signatures(),
         options.get_context_sensitivity(),
-        options.delimiter());
+        options.delimiter(),
+        options.get_compression(),
+        options.get_compression_level(),
+        options.get_max_open_files(),
+        options.get_compression_threads(),
+        options.get_function_threads(),
+        options.get_jobs(),
+        options.get_fact_cache(),
+        options.get_deduplicate(),
+        options.get_intern_symbols(),
+        options.get_lazy(),
+        options.get_print_stats());
   } catch (const ParseException &error) {
     std::cerr << error.what() << std::endl;
     return EXIT_FAILURE;
+  } catch (const std::ios_base::failure &error) {
+    std::cerr << error.what() << std::endl;
+    return EXIT_FAILURE;
   }
   return EXIT_SUCCESS;
 }
@@ -103,5 +277,16 @@ void factgen2(
       outputDir,
       llvm::Optional<boost::filesystem::path>(),
       INSENSITIVE,
-      delim);
+      delim,
+      cclyzer::Compression::GZIP,
+      cclyzer::DEFAULT_COMPRESSION_LEVEL,
+      cclyzer::FactWriter::DEFAULT_MAX_OPEN_FILES,
+      0,
+      0,
+      0,
+      llvm::Optional<boost::filesystem::path>(),
+      false,
+      false,
+      false,
+      false);
 }
@@ -8,9 +8,12 @@
 #include <cassert>
 #include <iostream>
 
+#include "FactWriter.hpp"
+
 namespace fs = boost::filesystem;
 namespace po = boost::program_options;
 
+using cclyzer::FactWriter;
 using cclyzer::Options;
 
 // NOLINTNEXTLINE(modernize-avoid-c-arrays)
@@ -19,6 +22,7 @@ Options::Options(int argc, char* argv[]) {
   fs::path outdir;
   fs::path signatures;
   fs::path signatures_sentinel("SENTINEL");
+  fs::path cache_dir;
 
   // Define and parse the program options
   po::options_description generic_opts("Options");
@@ -37,6 +41,44 @@ Options::Options(int argc, char* argv[]) {
       po::value<ContextSensitivity>(&context_sensitivity)
           ->default_value(INSENSITIVE),
       "Set context sensitivity")(
+      "compression",
+      po::value<Compression>(&compression)
+          ->default_value(Compression::GZIP, GZIP_COMPRESSION_STRING),
+      "Compression of generated facts: none, gzip or zstd (Souffle can't "
+      "read zstd)")(
+      "compression-level",
+      po::value<int>(&compression_level)
+          ->default_value(DEFAULT_COMPRESSION_LEVEL),
+      "Compression level (default -1, the codec's default)")(
+      "compression-threads",
+      po::value<std::size_t>(&compression_threads)->default_value(0),
+      "Compress facts on this many background threads (default 0, compress "
+      "on the main thread)")(
+      "function-threads",
+      po::value<std::size_t>(&function_threads)->default_value(0),
+      "Process functions on this many worker threads (default 0, process "
+      "them on the main thread)")(
+      "jobs,j",
+      po::value<std::size_t>(&jobs)->default_value(0),
+      "Process this many input files at once (default 0, process them one "
+      "after another on the main thread)")(
+      "max-open-files",
+      po::value<std::size_t>(&max_open_files)
+          ->default_value(FactWriter::DEFAULT_MAX_OPEN_FILES),
+      "Maximum number of fact files kept open at once")(
+      "deduplicate",
+      "Drop duplicate facts, reporting how many were dropped per predicate")(
+      "intern-symbols",
+      "Write each symbol once to a symbols file, and only refer to it by ID "
+      "in the facts (Souffle can't read these facts directly)")(
+      "fact-cache",
+      po::value<fs::path>(&cache_dir),
+      "Directory caching the facts of each function, to reuse those of "
+      "unchanged functions on later runs")(
+      "lazy",
+      "Load the body of each function just before processing it, and free it "
+      "afterwards, to reduce peak memory use")(
+      "print-stats", "Print statistics about fact generation")(
       "recursive,r", "Recurse into input directories")(
       "force,f", "Remove existing contents of output directory");
 
@@ -83,12 +125,37 @@ Options::Options(int argc, char* argv[]) {
     exit(ERROR_IN_COMMAND_LINE);
   }
 
+  if (!valid_compression_level(compression, compression_level)) {
+    std::cerr << "Invalid --compression-level " << compression_level
+              << " for " << compression_string(compression) << ", expected "
+              << compression_levels(compression) << std::endl;
+    exit(ERROR_IN_COMMAND_LINE);
+  }
+
   // Sanity checks
   assert(vm.count("out-dir"));
   assert(vm.count("input-files"));
 
   // Compute input files and create output directories
   std::vector<fs::path> paths = vm["input-files"].as<std::vector<fs::path> >();
+  deduplicate = vm.count("deduplicate") != 0U;
+  intern_symbols = vm.count("intern-symbols") != 0U;
+  lazy = vm.count("lazy") != 0U;
+  print_stats = vm.count("print-stats") != 0U;
+
+  if (vm.count("fact-cache") != 0U) {
+    fact_cache = llvm::Optional<fs::path>(std::move(cache_dir));
+  }
+
+  // Function bodies can't be loaded lazily by worker threads, nor be looked
+  // up in the fact cache
+  if (lazy && (function_threads > 0 || fact_cache.hasValue())) {
+    std::cerr << "Option --lazy can't be used with --function-threads or "
+                 "--fact-cache"
+              << std::endl;
+    exit(ERROR_IN_COMMAND_LINE);
+  }
+
   set_output_dir(outdir, vm.count("force") != 0U);
   set_input_files(paths.begin(), paths.end(), vm.count("recursive") != 0U);
 
@@ -0,0 +1,114 @@
+#include "OrderedJobs.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+void cclyzer::run_ordered_jobs(
+    std::size_t jobs,
+    std::size_t threads,
+    std::size_t maxPendingJobs,
+    const std::function<void(std::size_t thread, std::size_t job)> &work,
+    const std::function<void(std::size_t job)> &consume) {
+  if (threads == 0) {
+    for (std::size_t job = 0; job < jobs; job++) {
+      work(0, job);
+      consume(job);
+    }
+    return;
+  }
+
+  maxPendingJobs = std::max<std::size_t>(maxPendingJobs, 1);
+
+  // Guards all of the below
+  std::mutex mutex;
+
+  // Signaled when a job is done, and when a job is consumed
+  std::condition_variable jobDone;
+  std::condition_variable jobConsumed;
+
+  std::vector<bool> done(jobs, false);
+  std::vector<std::exception_ptr> errors(jobs);
+  std::size_t nextJob = 0;
+  std::size_t jobsConsumed = 0;
+  bool stopping = false;
+
+  auto run = [&](std::size_t thread) {
+    for (;;) {
+      std::size_t job;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        jobConsumed.wait(lock, [&] {
+          return stopping || nextJob == jobs ||
+                 nextJob < jobsConsumed + maxPendingJobs;
+        });
+        if (stopping || nextJob == jobs) {
+          return;
+        }
+        job = nextJob++;
+      }
+
+      std::exception_ptr error;
+      try {
+        work(thread, job);
+      } catch (...) {
+        error = std::current_exception();
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        errors[job] = error;
+        done[job] = true;
+      }
+      jobDone.notify_one();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(threads);
+  for (std::size_t thread = 0; thread < threads; thread++) {
+    workers.emplace_back(run, thread);
+  }
+
+  std::exception_ptr error;
+  for (std::size_t job = 0; job < jobs && !error; job++) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      jobDone.wait(lock, [&] { return done[job]; });
+      error = errors[job];
+    }
+    if (error) {
+      break;
+    }
+
+    try {
+      consume(job);
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      jobsConsumed++;
+    }
+    jobConsumed.notify_all();
+  }
+
+  // Let the workers finish their current job and exit
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  jobConsumed.notify_all();
+
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
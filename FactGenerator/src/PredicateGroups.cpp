@@ -8,7 +8,7 @@ namespace cclyzer::predicates {
 // GROUP_BEGIN, GROUP_END not needed
 #define GROUP_BEGIN(g)
 #define GROUP_END(group_end)
-#define PREDICATE(g, p, f) pred_t g::p(#f);
+#define PREDICATE(g, p, f) pred_t g::p(#f, g##_##p);
 #include "predicates.inc"
 
 // Register the predicates
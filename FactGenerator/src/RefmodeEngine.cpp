@@ -11,6 +11,7 @@
 #include "RefmodeEngineImpl.hpp"
 
 using cclyzer::refmode_t;
+using cclyzer::refmode_view_t;
 using cclyzer::RefmodeEngine;
 using llvm::cast;
 using llvm::dyn_cast;
@@ -33,28 +34,36 @@ auto RefmodeEngine::Impl::refmode(const T& obj) -> refmode_t  // const
 }
 
 template <>
-auto RefmodeEngine::Impl::refmode(const llvm::Type& type) -> refmode_t  // const
-{
-  string type_str;
-  raw_string_ostream rso(type_str);
-
-  if (type.isStructTy()) {
-    const auto* s_ty = cast<llvm::StructType>(&type);
-
-    if (s_ty->isLiteral()) {
+auto RefmodeEngine::Impl::refmodeView(const llvm::Type& type)
+    -> refmode_view_t {
+  return memoize(typeRefmodes, typeStats, &type, [&type] {
+    string type_str;
+    raw_string_ostream rso(type_str);
+
+    if (type.isStructTy()) {
+      const auto* s_ty = cast<llvm::StructType>(&type);
+
+      if (s_ty->isLiteral()) {
+        type.print(rso);
+        return rso.str();
+      }
+
+      if (s_ty->hasName()) {
+        rso << "%" << s_ty->getName();
+        return rso.str();
+      }
+      rso << "%\"type " << s_ty << "\"";
+    } else {
       type.print(rso);
-      return rso.str();
     }
+    return rso.str();
+  });
+}
 
-    if (s_ty->hasName()) {
-      rso << "%" << s_ty->getName();
-      return rso.str();
-    }
-    rso << "%\"type " << s_ty << "\"";
-  } else {
-    type.print(rso);
-  }
-  return rso.str();
+template <>
+auto RefmodeEngine::Impl::refmode(const llvm::Type& type) -> refmode_t  // const
+{
+  return refmode_t(refmodeView(type));
 }
 
 template <>
@@ -83,15 +92,23 @@ auto RefmodeEngine::Impl::refmode(const llvm::Constant& constant)
   return refmode.str();
 }
 
+template <>
+auto RefmodeEngine::Impl::refmodeView(const llvm::BasicBlock& basicblock)
+    -> refmode_view_t {
+  return memoizeLocal(basicblock, [this, &basicblock] {
+    string bb_name = refmodeOf(&basicblock);
+    std::ostringstream refmode;
+
+    withContext<llvm::Function>(refmode) << "[basicblock]" << bb_name;
+    return refmode.str();
+  });
+}
+
 template <>
 auto RefmodeEngine::Impl::refmode(const llvm::BasicBlock& basicblock)
     -> refmode_t  // const
 {
-  string bb_name = refmodeOf(&basicblock);
-  std::ostringstream refmode;
-
-  withContext<llvm::Function>(refmode) << "[basicblock]" << bb_name;
-  return refmode.str();
+  return refmode_t(refmodeView(basicblock));
 }
 
 template <>
@@ -130,17 +147,25 @@ auto RefmodeEngine::Impl::refmode(const llvm::GlobalValue& val)
 }
 
 template <>
-auto RefmodeEngine::Impl::refmode(const llvm::Value& val) -> refmode_t  // const
-{
+auto RefmodeEngine::Impl::refmodeView(const llvm::Value& val)
+    -> refmode_view_t {
   if (const auto* bb = dyn_cast<llvm::BasicBlock>(&val)) {
-    return refmode<llvm::BasicBlock>(*bb);
+    return refmodeView<llvm::BasicBlock>(*bb);
   }
 
-  refmode_t id = refmodeOf(&val);
-  std::ostringstream refmode;
+  return memoizeLocal(val, [this, &val] {
+    refmode_t id = refmodeOf(&val);
+    std::ostringstream refmode;
 
-  withContext<llvm::Function>(refmode) << id;
-  return refmode.str();
+    withContext<llvm::Function>(refmode) << id;
+    return refmode.str();
+  });
+}
+
+template <>
+auto RefmodeEngine::Impl::refmode(const llvm::Value& val) -> refmode_t  // const
+{
+  return refmode_t(refmodeView(val));
 }
 
 template <>
@@ -185,6 +210,11 @@ auto RefmodeEngine::refmode(const T& obj) const -> refmode_t {
   return impl->refmode(obj);
 }
 
+template <typename T>
+auto RefmodeEngine::refmodeView(const T& obj) const -> refmode_view_t {
+  return impl->refmodeView(obj);
+}
+
 void RefmodeEngine::enterContext(const llvm::Value& val) {
   impl->enterContext(val);
 }
@@ -206,6 +236,24 @@ auto RefmodeEngine::moduleContext() -> const llvm::Module* {
   return impl->moduleContext();
 }
 
+auto RefmodeEngine::valueCacheStats() const -> CacheStats {
+  return impl->valueCacheStats();
+}
+
+auto RefmodeEngine::typeCacheStats() const -> CacheStats {
+  return impl->typeCacheStats();
+}
+
+void RefmodeEngine::print(
+    const llvm::GlobalValue& global, llvm::raw_ostream& out) const {
+  impl->print(global, out);
+}
+
+void RefmodeEngine::print(
+    const llvm::Metadata& meta, llvm::raw_ostream& out) const {
+  impl->print(meta, out);
+}
+
 //------------------------------------------------------------------------------
 // Explicit template instantiations
 //------------------------------------------------------------------------------
@@ -254,3 +302,12 @@ template refmode_t RefmodeEngine::refmode<llvm::DINode>(
 
 template refmode_t RefmodeEngine::refmode<llvm::MDNode>(
     const llvm::MDNode&) const;
+
+template refmode_view_t RefmodeEngine::refmodeView<llvm::Type>(
+    const llvm::Type&) const;
+
+template refmode_view_t RefmodeEngine::refmodeView<llvm::BasicBlock>(
+    const llvm::BasicBlock&) const;
+
+template refmode_view_t RefmodeEngine::refmodeView<llvm::Value>(
+    const llvm::Value&) const;
@@ -5,7 +5,6 @@
 
 #include <boost/algorithm/string.hpp>
 #include <boost/flyweight.hpp>
-#include <map>
 
 using cclyzer::refmode_t;
 using cclyzer::RefmodeEngine;
@@ -94,9 +93,13 @@ void RefmodeEngine::Impl::appendMetadataId(
 
 void RefmodeEngine::Impl::computeNumbering(
     const llvm::Function *func,
-    std::map<const llvm::Value *, unsigned> &numbering) {
+    ContextManager::numbering_t &numbering) {
   unsigned counter = 0;
 
+  // Upper bound on the number of unnamed values, so the map never regrows
+  numbering.reserve(static_cast<unsigned>(
+      func->arg_size() + func->size() + func->getInstructionCount()));
+
   // Arguments get the first numbers.
   for (const auto &arg : func->args()) {
     if (!arg.hasName()) {
@@ -1,4 +1,7 @@
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/IR/ModuleSlotTracker.h>
+#include <llvm/Support/Allocator.h>
+#include <llvm/Support/StringSaver.h>
 
 #include <memory>
 #include <sstream>
@@ -8,6 +11,7 @@
 
 // Forward declaration
 namespace llvm {
+class raw_ostream;
 class raw_string_ostream;
 }
 
@@ -18,17 +22,46 @@ class cclyzer::RefmodeEngine::Impl {
   template <typename T>
   auto refmode(const T &obj) -> refmode_t;  // const;
 
+  // Compute memoized refmode for obj, as a view into the arena
+  template <typename T>
+  auto refmodeView(const T &obj) -> refmode_view_t;
+
   //-------------------------------------------------
   // Context management
   //-------------------------------------------------
 
-  void enterContext(const llvm::Value &val) { ctx->pushContext(val); }
+  void enterContext(const llvm::Value &val) {
+    ctx->pushContext(val);
+    contextRefmodes.clear();
 
-  void exitContext() { ctx->popContext(); }
+    // Number the metadata of lazily loaded functions as they come, which
+    // yields the same slots as numbering it all up front
+    if (!allMetadataNumbered) {
+      if (const auto *func = llvm::dyn_cast<llvm::Function>(&val)) {
+        slotTracker->incorporateFunction(*func);
+      }
+    }
+  }
+
+  void exitContext() {
+    // Memoized refmodes are only valid within their function
+    if (ctx->rbegin()->isFunction) {
+      localRefmodes.clear();
+    }
+    ctx->popContext();
+    contextRefmodes.clear();
+  }
 
   void enterModule(const llvm::Module &module, const std::string &path) {
-    slotTracker = std::make_unique<llvm::ModuleSlotTracker>(&module);
+    // Function bodies that aren't loaded yet have no metadata to number
+    allMetadataNumbered = module.isMaterialized();
+    slotTracker = std::make_unique<llvm::ModuleSlotTracker>(
+        &module, allMetadataNumbered);
     ctx = std::make_unique<ContextManager>(module, path);
+    localRefmodes.clear();
+    contextRefmodes.clear();
+    typeRefmodes.clear();
+    arena.Reset();
   }
 
   void exitModule() {}
@@ -42,6 +75,20 @@ class cclyzer::RefmodeEngine::Impl {
 
   auto moduleContext() -> const llvm::Module * { return &ctx->module(); }
 
+  [[nodiscard]] auto valueCacheStats() const -> CacheStats {
+    return localStats;
+  }
+
+  [[nodiscard]] auto typeCacheStats() const -> CacheStats { return typeStats; }
+
+  void print(const llvm::GlobalValue &global, llvm::raw_ostream &out) {
+    static_cast<const llvm::Value &>(global).print(out, *slotTracker);
+  }
+
+  void print(const llvm::Metadata &meta, llvm::raw_ostream &out) {
+    meta.print(out, *slotTracker, &ctx->module());
+  }
+
  protected:
   // Methods that compute refmodes for various LLVM types
   auto refmodeOf(const llvm::Value *Val) -> refmode_t;
@@ -50,11 +97,48 @@ class cclyzer::RefmodeEngine::Impl {
 
   // Compute variable numberings
   static void computeNumbering(
-      const llvm::Function *, std::map<const llvm::Value *, unsigned> &);
+      const llvm::Function *, ContextManager::numbering_t &);
 
   // Compute all metadata slots
   void parseMetadata(const llvm::Module *module);
 
+  // Copy a refmode into the arena
+  auto save(const refmode_t &refmode) -> refmode_view_t {
+    llvm::StringRef saved = saver.save(refmode);
+    return {saved.data(), saved.size()};
+  }
+
+  // Look up a memoized refmode, computing (and memoizing) it if needed
+  template <typename K, typename F>
+  auto memoize(
+      llvm::DenseMap<K, refmode_view_t> &cache,
+      CacheStats &stats,
+      K key,
+      F compute) -> refmode_view_t {
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+      stats.hits++;
+      return it->second;
+    }
+    stats.misses++;
+
+    // May recursively compute other refmodes, so insert afterwards
+    refmode_view_t refmode = save(compute());
+    cache.try_emplace(key, refmode);
+    return refmode;
+  }
+
+  // Memoize a refmode that depends on the current function context. Outside
+  // of functions, refmodes depend on the whole context stack, so they're only
+  // memoized until it changes.
+  template <typename F>
+  auto memoizeLocal(const llvm::Value &val, F compute) -> refmode_view_t {
+    if (ctx->functionContext() == nullptr) {
+      return memoize(contextRefmodes, localStats, &val, compute);
+    }
+    return memoize(localRefmodes, localStats, &val, compute);
+  }
+
   template <typename T, typename S>
   auto withContext(S &stream) const -> S & {
     for (const auto &it : *ctx) {
@@ -89,4 +173,19 @@ class cclyzer::RefmodeEngine::Impl {
   // Slot tracker and context manager
   std::unique_ptr<llvm::ModuleSlotTracker> slotTracker;
   std::unique_ptr<ContextManager> ctx;
+
+  // Whether the slot tracker numbers the metadata of all functions itself
+  bool allMetadataNumbered = true;
+
+  // Arena of memoized refmodes, reset for each module
+  llvm::BumpPtrAllocator arena;
+  llvm::StringSaver saver{arena};
+
+  // Memoized refmodes of values in the current function, of values in the
+  // current context outside of functions, and of types
+  llvm::DenseMap<const llvm::Value *, refmode_view_t> localRefmodes;
+  llvm::DenseMap<const llvm::Value *, refmode_view_t> contextRefmodes;
+  llvm::DenseMap<const llvm::Type *, refmode_view_t> typeRefmodes;
+  CacheStats localStats;
+  CacheStats typeStats;
 };
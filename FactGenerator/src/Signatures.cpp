@@ -1,5 +1,9 @@
 #include "Signatures.hpp"
 
+#include <algorithm>
+#include <cctype>
+#include <utility>
+
 template <typename T>
 auto extract_from_array(const llvm::json::Array &json_array, size_t index)
     -> llvm::Optional<T>;
@@ -80,8 +84,237 @@ void write_pts_signature(
   }
 }
 
+// Longest literal string that all matches of the given regular expression (in
+// ECMAScript syntax) contain, or an empty string if none is readily found
+static auto required_literal(const std::string &pattern) -> std::string {
+  std::vector<std::string> runs(1);
+
+  // Index just past the character class starting at the given index
+  auto skip_class = [&pattern](std::size_t i) {
+    for (i++; i < pattern.size() && pattern[i] != ']'; i++) {
+      if (pattern[i] == '\\') {
+        i++;
+      }
+    }
+    return i + 1;
+  };
+
+  std::size_t i = 0;
+  while (i < pattern.size()) {
+    const char c = pattern[i];
+    switch (c) {
+      case '\\': {
+        // Escaped letters and digits are character classes, assertions,
+        // character codes or back-references, other escaped characters are
+        // literal
+        if (i + 1 >= pattern.size()) {
+          return "";
+        }
+        const char escaped = pattern[i + 1];
+        i += 2;
+        if (std::isalnum(static_cast<unsigned char>(escaped)) == 0) {
+          runs.back() += escaped;
+          break;
+        }
+        runs.emplace_back();
+        switch (escaped) {
+          case 'b':
+          case 'B':
+          case 'd':
+          case 'D':
+          case 'f':
+          case 'n':
+          case 'r':
+          case 's':
+          case 'S':
+          case 't':
+          case 'v':
+          case 'w':
+          case 'W':
+          case '0':
+            break;
+          case 'c':
+            // Control character
+            i++;
+            break;
+          case 'x':
+            // Character code of two hex digits
+            i += 2;
+            break;
+          case 'u':
+            // Character code of four hex digits
+            i += 4;
+            break;
+          default:
+            if (std::isdigit(static_cast<unsigned char>(escaped)) == 0) {
+              // Not an escape this parser knows about
+              return "";
+            }
+            // Back-reference, whose number may have several digits
+            while (i < pattern.size() &&
+                   std::isdigit(static_cast<unsigned char>(pattern[i])) != 0) {
+              i++;
+            }
+        }
+        break;
+      }
+      case '[':
+        i = skip_class(i);
+        runs.emplace_back();
+        break;
+      case '(': {
+        // Skip the whole group, which may have alternatives
+        std::size_t depth = 1;
+        for (i++; i < pattern.size() && depth > 0;) {
+          if (pattern[i] == '\\') {
+            i += 2;
+          } else if (pattern[i] == '[') {
+            i = skip_class(i);
+          } else {
+            if (pattern[i] == '(') {
+              depth++;
+            } else if (pattern[i] == ')') {
+              depth--;
+            }
+            i++;
+          }
+        }
+        runs.emplace_back();
+        break;
+      }
+      case '*':
+      case '?':
+      case '{':
+        // The preceding character may be missing
+        if (!runs.back().empty()) {
+          runs.back().pop_back();
+        }
+        runs.emplace_back();
+        i = c == '{' ? pattern.find('}', i) : i;
+        i = i == std::string::npos ? pattern.size() : i + 1;
+        break;
+      case '|':
+        // Matches of either alternative needn't have anything in common
+        return "";
+      case '+':
+      case '.':
+      case '^':
+      case '$':
+        runs.emplace_back();
+        i++;
+        break;
+      default:
+        runs.back() += c;
+        i++;
+    }
+  }
+
+  return *std::max_element(
+      runs.begin(), runs.end(), [](const auto &a, const auto &b) {
+        return a.size() < b.size();
+      });
+}
+
+cclyzer::SignatureList::SignatureList(std::vector<entry_t> entries)
+    : entries(std::move(entries)) {
+  for (std::size_t i = 0; i < this->entries.size(); i++) {
+    const std::string literal = required_literal(std::get<0>(this->entries[i]));
+    if (literal.empty()) {
+      unfiltered.push_back(i);
+    } else {
+      addLiteral(literal, i);
+    }
+  }
+  link();
+}
+
+void cclyzer::SignatureList::addLiteral(
+    const std::string &literal, std::size_t pattern) {
+  std::uint32_t current = 0;
+  for (const char c : literal) {
+    const auto [it, inserted] = transitions.try_emplace(
+        (std::uint64_t{current} << 8U) | static_cast<unsigned char>(c),
+        static_cast<std::uint32_t>(states.size()));
+    if (inserted) {
+      states.emplace_back();
+    }
+    current = it->second;
+  }
+  states[current].patterns.push_back(pattern);
+}
+
+void cclyzer::SignatureList::link() {
+  // Transitions by source state
+  std::vector<std::vector<std::pair<unsigned char, std::uint32_t>>> children(
+      states.size());
+  for (const auto &[key, to] : transitions) {
+    children[key >> 8U].emplace_back(static_cast<unsigned char>(key), to);
+  }
+
+  // Visit states breadth-first, so that shorter suffixes come first
+  std::vector<std::uint32_t> queue{0};
+  for (std::size_t i = 0; i < queue.size(); i++) {
+    const std::uint32_t parent = queue[i];
+    for (const auto &[c, child] : children[parent]) {
+      std::uint32_t fail = 0;
+      if (parent != 0) {
+        fail = states[parent].fail;
+        while (fail != 0 && next(fail, c) == 0) {
+          fail = states[fail].fail;
+        }
+        fail = next(fail, c);
+      }
+      states[child].fail = fail;
+      states[child].output =
+          states[fail].patterns.empty() ? states[fail].output : fail;
+      queue.push_back(child);
+    }
+  }
+}
+
+auto cclyzer::SignatureList::next(std::uint32_t from, unsigned char c) const
+    -> std::uint32_t {
+  const auto it = transitions.find((std::uint64_t{from} << 8U) | c);
+  return it == transitions.end() ? 0 : it->second;
+}
+
+auto cclyzer::SignatureList::matching(const std::string &name) const
+    -> std::vector<const llvm::json::Array *> {
+  // Find the patterns whose literal occurs in the name
+  std::vector<std::size_t> candidates(unfiltered);
+  std::uint32_t current = 0;
+  for (const char ch : name) {
+    const auto c = static_cast<unsigned char>(ch);
+    while (current != 0 && next(current, c) == 0) {
+      current = states[current].fail;
+    }
+    current = next(current, c);
+
+    std::uint32_t found =
+        states[current].patterns.empty() ? states[current].output : current;
+    for (; found != 0; found = states[found].output) {
+      candidates.insert(
+          candidates.end(),
+          states[found].patterns.begin(),
+          states[found].patterns.end());
+    }
+  }
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(
+      std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+  // Try those patterns in full
+  std::vector<const llvm::json::Array *> signatures;
+  for (const std::size_t i : candidates) {
+    if (std::regex_search(name, std::get<1>(entries[i]))) {
+      signatures.push_back(&std::get<2>(entries[i]));
+    }
+  }
+  return signatures;
+}
+
 auto preprocess_signatures(const boost::filesystem::path &signatures_path)
-    -> std::vector<std::tuple<std::string, std::regex, llvm::json::Array>> {
+    -> cclyzer::SignatureList {
   std::vector<std::tuple<std::string, std::regex, llvm::json::Array>>
       functions_with_signatures;
   std::ifstream ifs(signatures_path);
@@ -115,7 +348,7 @@ auto preprocess_signatures(const boost::filesystem::path &signatures_path)
     functions_with_signatures.emplace_back(
         function_name, function_name, *function_array);
   }
-  return functions_with_signatures;
+  return cclyzer::SignatureList(std::move(functions_with_signatures));
 }
 
 void emit_signatures(
@@ -0,0 +1,42 @@
+#include "ValueTable.hpp"
+
+using cclyzer::ValueTable;
+
+auto ValueTable::insert(llvm::StringRef refmode, const llvm::Value *value)
+    -> bool {
+  const auto [entry, inserted] = ids.try_emplace(refmode, size());
+  if (inserted) {
+    values.push_back(value);
+    refmodes.push_back(&*entry);
+  }
+  return inserted;
+}
+
+void ValueTable::append(const ValueTable &other) {
+  for (id_type id = 0; id < other.size(); id++) {
+    insert(other.refmode(id), other.value(id));
+  }
+}
+
+void ValueTable::eraseIf(
+    id_type first, llvm::function_ref<bool(const llvm::Value *)> pred) {
+  id_type kept = first;
+  for (id_type id = first; id < size(); id++) {
+    if (pred(values[id])) {
+      ids.erase(refmodes[id]->getKey());
+      continue;
+    }
+    values[kept] = values[id];
+    refmodes[kept] = refmodes[id];
+    refmodes[kept]->second = kept;
+    kept++;
+  }
+  values.resize(kept);
+  refmodes.resize(kept);
+}
+
+void ValueTable::clear() {
+  values.clear();
+  refmodes.clear();
+  ids.clear();
+}
@@ -13,19 +13,20 @@ void FactGenerator::writeLocalVariables() {
   const std::string funcname = "@" + containing_function->getName().str();
 
   // Record every variable encountered so far
-  for (const auto &[varId, type] : variableTypes) {
+  for (const llvm::Value *var : variables) {
+    refmode_view_t varId = refmodeView<llvm::Value>(*var);
+
     // Record variable entity with its type and containing function
     writeFact(pred::variable::id, varId);
-    writeFact(pred::variable::type, varId, recordType(type));
+    writeFact(pred::variable::type, varId, recordType(var->getType()));
     writeFact(pred::variable::in_func, varId, funcname);
 
     // Record variable name part
     size_t idx = varId.find_last_of("%!");
-    if (idx != llvm::StringRef::npos) {
-      std::string var_name = varId.substr(idx);
-      writeFact(pred::variable::name, varId, var_name);
+    if (idx != refmode_view_t::npos) {
+      writeFact(pred::variable::name, varId, varId.substr(idx));
     }
   }
 
-  variableTypes.clear();
+  variables.clear();
 }
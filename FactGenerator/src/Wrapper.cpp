@@ -12,10 +12,11 @@ auto factgen_module(
     llvm::Module &module,
     const fs::path &output_dir,
     const llvm::Optional<boost::filesystem::path> &signatures,
-    ContextSensitivity sensitivity)
-    -> std::tuple<
-        fs::path,
-        std::map<boost::flyweight<std::string>, const llvm::Value *>> {
+    ContextSensitivity sensitivity,
+    cclyzer::Compression compression,
+    int compression_level,
+    bool intern_symbols)
+    -> std::tuple<fs::path, cclyzer::ValueTable> {
   using cclyzer::FactGenerator;
   using cclyzer::FactWriter;
   using cclyzer::predicates::predicates_reg;
@@ -23,8 +24,17 @@ auto factgen_module(
   std::cerr << "Writing facts to: " << output_dir << "...\n";
 
   // initialize factgen and output writer
-  FactWriter writer(predicates_reg, output_dir, "\t");
-  FactGenerator &gen = FactGenerator::getInstance(writer);
+  FactWriter writer(
+      predicates_reg,
+      output_dir,
+      "\t",
+      compression,
+      compression_level,
+      FactWriter::DEFAULT_MAX_OPEN_FILES,
+      0,
+      false,
+      intern_symbols);
+  FactGenerator gen(writer);
   const std::string &real_path = module.getSourceFileName();
 
   // do the fact generation
@@ -32,6 +42,30 @@ auto factgen_module(
 
   const llvm::DataLayout &layout = module.getDataLayout();
   gen.writeTypes(layout);
+  writer.close();
 
   return std::make_tuple(output_dir, std::move(res_maps));
 }
+
+auto factgen_module(
+    llvm::Module &module,
+    cclyzer::FactSink &sink,
+    const llvm::Optional<boost::filesystem::path> &signatures,
+    ContextSensitivity sensitivity)
+    -> cclyzer::ValueTable {
+  using cclyzer::FactGenerator;
+  using cclyzer::FactWriter;
+
+  // initialize factgen and in-memory writer
+  FactWriter writer(sink);
+  FactGenerator gen(writer);
+  const std::string &real_path = module.getSourceFileName();
+
+  // do the fact generation
+  auto res_maps = gen.processModule(module, real_path, signatures, sensitivity);
+
+  const llvm::DataLayout &layout = module.getDataLayout();
+  gen.writeTypes(layout);
+
+  return res_maps;
+}
@@ -0,0 +1,16 @@
+#ifndef ALLOCATIONID_H
+#define ALLOCATIONID_H
+
+#include <cstdint>
+
+namespace cclyzer {
+
+// Handle of an allocation in the results of the pointer analysis. Handles are
+// numbered from 0 in the order their allocations are first read, and the names
+// of allocations are kept on the side (see
+// PointerAnalysisAAResult::getAllocationName).
+enum class AllocationId : std::uint32_t {};
+
+}  // namespace cclyzer
+
+#endif  // ALLOCATIONID_H
@@ -1,6 +1,20 @@
 #include "PAInterface.h"
 
+#include <souffle/RamTypes.h>
 #include <souffle/SouffleInterface.h>
+#include <souffle/utility/StringUtil.h>
+
+#include <boost/iostreams/device/file.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/zstd.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include <string_view>
+
+#include "FactWriter.hpp"
+#include "PredicateGroups.hpp"
 
 // Public-facing interface to creating an instance
 auto PAInterface::create(const std::string& dl_base_file)
@@ -21,6 +35,45 @@ PAInterface::PAInterface(souffle::SouffleProgram* program)
 
 PAInterface::~PAInterface() = default;
 
+auto PAInterface::createFactSink() -> std::unique_ptr<cclyzer::FactSink> {
+  return std::make_unique<SouffleFactSink>(*souffle_program_);
+}
+
+//------------------------------------------------------------------------------
+// Symbols
+
+auto SymbolResolver::value(souffle::RamDomain symbol) -> const llvm::Value* {
+  const llvm::Value*& value = values_[symbol];
+  if (value == nullptr) {
+    const std::string& refmode = symbols_.decode(symbol);
+    value = llvm_val_map_.find(refmode);
+    if (value == nullptr) {
+      std::cout << "Failed value* lookup: " << refmode << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+  return value;
+}
+
+auto SymbolResolver::allocation(souffle::RamDomain symbol)
+    -> cclyzer::AllocationId {
+  const auto [it, inserted] = allocations_.try_emplace(
+      symbol, static_cast<cclyzer::AllocationId>(allocation_names_.size()));
+  if (inserted) {
+    allocation_names_.push_back(&symbols_.decode(symbol));
+  }
+  return it->second;
+}
+
+auto SymbolResolver::string(souffle::RamDomain symbol)
+    -> boost::flyweight<std::string> {
+  auto it = strings_.find(symbol);
+  if (it == strings_.end()) {
+    it = strings_.try_emplace(symbol, symbols_.decode(symbol)).first;
+  }
+  return it->second;
+}
+
 //------------------------------------------------------------------------------
 // Main entry point for running the pointer analysis, after factgen has
 // completed
@@ -33,8 +86,13 @@ auto PAInterface::runPointerAnalysis(
   }
 
   // Now we can tell Souffle to load the files, including the configuration
-  // file, and to run the pointer analysis.
-  souffle_program_->loadAll(p.string());
+  // file, and to run the pointer analysis. In-memory facts have already been
+  // inserted by the fact sink.
+  if (flags & PAFlags::FACTS_INTERNED) {
+    loadInternedFacts(p);
+  } else if (!(flags & PAFlags::FACTS_IN_MEMORY)) {
+    souffle_program_->loadAll(p.string());
+  }
   souffle_program_->run();
 
   if (flags & PAFlags::WRITE_ALL) {
@@ -45,6 +103,243 @@ auto PAInterface::runPointerAnalysis(
   return 0;
 }
 
+//------------------------------------------------------------------------------
+// Interned facts
+
+// Open a fact file written with the given codec
+static void open_fact_file(
+    boost::iostreams::filtering_istream& in,
+    const boost::filesystem::path& file,
+    cclyzer::Compression compression) {
+  namespace io = boost::iostreams;
+
+  switch (compression) {
+    case cclyzer::Compression::NONE:
+      break;
+    case cclyzer::Compression::GZIP:
+      in.push(io::gzip_decompressor());
+      break;
+    case cclyzer::Compression::ZSTD:
+      in.push(io::zstd_decompressor());
+      break;
+  }
+  if (!boost::filesystem::exists(file)) {
+    throw std::runtime_error("Missing fact file: " + file.string());
+  }
+  in.push(io::file_source(file.string()));
+}
+
+// Parse a number written by the fact generator, which are all decimal
+template <typename T>
+static auto parse_number(std::string_view text, T& number) -> bool {
+  auto result = std::from_chars(text.data(), text.data() + text.size(), number);
+  return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+// Raw value of a field of the given Souffle type, converted the same way
+// Souffle's CSV reader does
+static auto from_string(
+    souffle::SymbolTable& symbol_table, char type, const std::string& text)
+    -> souffle::RamDomain {
+  switch (type) {
+    case 'i':
+      return souffle::ramBitCast(souffle::RamSignedFromString(text));
+    case 'u':
+      return souffle::ramBitCast(souffle::RamUnsignedFromString(text));
+    case 'f':
+      return souffle::ramBitCast(souffle::RamFloatFromString(text));
+    default:
+      return symbol_table.encode(text);
+  }
+}
+
+// Raw value of a field of an interned fact file, of the given Souffle type.
+// Integer fields are written as is, other fields as symbol IDs, see
+// FactWriter::internFields. Returns false if the field is malformed.
+static auto interned_field(
+    souffle::SymbolTable& symbol_table,
+    const std::vector<souffle::RamDomain>& symbols,
+    char type,
+    std::string_view field,
+    souffle::RamDomain& value) -> bool {
+  if (!field.empty() && field.front() == cclyzer::FactWriter::INTEGER_PREFIX) {
+    field.remove_prefix(1);
+    if (type == 'i') {
+      souffle::RamSigned number = 0;
+      if (!parse_number(field, number)) {
+        return false;
+      }
+      value = souffle::ramBitCast(number);
+      return true;
+    }
+    if (type == 'u') {
+      souffle::RamUnsigned number = 0;
+      if (!parse_number(field, number)) {
+        return false;
+      }
+      value = souffle::ramBitCast(number);
+      return true;
+    }
+    value = from_string(symbol_table, type, std::string(field));
+    return true;
+  }
+
+  std::size_t id = 0;
+  if (!parse_number(field, id) || id >= symbols.size()) {
+    return false;
+  }
+  switch (type) {
+    case 'i':
+    case 'u':
+    case 'f':
+      // Numbers that weren't written as integers, e.g. floats
+      value = from_string(symbol_table, type, symbol_table.decode(symbols[id]));
+      return true;
+    default:
+      value = symbols[id];
+      return true;
+  }
+}
+
+void PAInterface::loadInternedFacts(const boost::filesystem::path& dir) {
+  namespace fs = boost::filesystem;
+  using cclyzer::Compression;
+  using cclyzer::FactWriter;
+
+  // The facts use the codec of the symbols file
+  fs::path symbols_file;
+  Compression compression = Compression::NONE;
+  for (Compression codec :
+       {Compression::NONE, Compression::GZIP, Compression::ZSTD}) {
+    fs::path file = dir / FactWriter::SYMBOLS_FILE;
+    file += cclyzer::compression_extension(codec);
+    if (fs::exists(file)) {
+      symbols_file = file;
+      compression = codec;
+      break;
+    }
+  }
+  if (symbols_file.empty()) {
+    throw std::runtime_error("No symbols file in: " + dir.string());
+  }
+
+  // Encode each symbol just once. The symbol with ID n is on line n.
+  souffle::SymbolTable& symbol_table = souffle_program_->getSymbolTable();
+  std::vector<souffle::RamDomain> symbols;
+  std::string line;
+  {
+    boost::iostreams::filtering_istream in;
+    open_fact_file(in, symbols_file, compression);
+    while (std::getline(in, line)) {
+      symbols.push_back(symbol_table.encode(line));
+    }
+  }
+
+  std::set<std::string> loaded;
+  std::vector<char> types;
+  for (const cclyzer::Predicate* pred : cclyzer::predicates::predicates_reg) {
+    // Predicates may share a file
+    if (!loaded.insert(pred->getName()).second) {
+      continue;
+    }
+
+    // The input relations are named after the predicates, see import.dl
+    souffle::Relation* relation =
+        souffle_program_->getRelation(pred->getName());
+    if (relation == nullptr) {
+      throw std::logic_error(
+          "No input relation for predicate: " + pred->getName());
+    }
+    const std::size_t arity = relation->getArity();
+    types.resize(arity);
+    for (std::size_t i = 0; i < arity; i++) {
+      types[i] = *relation->getAttrType(i);
+    }
+
+    fs::path file = dir / pred->getName();
+    file += cclyzer::compression_extension(compression);
+    boost::iostreams::filtering_istream in;
+    open_fact_file(in, file, compression);
+
+    // Insert the raw values of the tab-separated fields
+    souffle::tuple tuple(relation);
+    while (std::getline(in, line)) {
+      const char* field = line.data();
+      const char* end = line.data() + line.size();
+      for (std::size_t i = 0;; i++) {
+        const char* next = std::find(field, end, '\t');
+        if (i >= arity ||
+            !interned_field(
+                symbol_table,
+                symbols,
+                types[i],
+                std::string_view(
+                    field, static_cast<std::size_t>(next - field)),
+                tuple[i])) {
+          throw std::runtime_error("Malformed fact in: " + file.string());
+        }
+        if (next == end) {
+          if (i + 1 != arity) {
+            throw std::runtime_error("Malformed fact in: " + file.string());
+          }
+          break;
+        }
+        field = next + 1;
+      }
+      relation->insert(tuple);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Fact sink
+
+auto SouffleFactSink::getRelation(const cclyzer::Predicate& pred)
+    -> souffle::Relation* {
+  const std::size_t index = pred.getIndex();
+  if (index < relations_.size() && relations_[index] != nullptr) {
+    return relations_[index];
+  }
+
+  // The input relations are named after the predicates, see import.dl
+  souffle::Relation* relation = program_.getRelation(pred.getName());
+  if (relation == nullptr) {
+    throw std::logic_error(
+        "No input relation for predicate: " + pred.getName());
+  }
+  if (index >= relations_.size()) {
+    relations_.resize(index + 1, nullptr);
+  }
+  relations_[index] = relation;
+  return relation;
+}
+
+void SouffleFactSink::insert(
+    const cclyzer::Predicate& pred, const std::vector<std::string>& fields) {
+  souffle::Relation* relation = getRelation(pred);
+  assert(relation->getArity() == fields.size());
+
+  // Convert the fields the same way Souffle's CSV reader does
+  souffle::tuple tuple(relation);
+  for (std::size_t i = 0; i < fields.size(); ++i) {
+    switch (*relation->getAttrType(i)) {
+      case 'i':
+        tuple << souffle::RamSignedFromString(fields[i]);
+        break;
+      case 'u':
+        tuple << souffle::RamUnsignedFromString(fields[i]);
+        break;
+      case 'f':
+        tuple << souffle::RamFloatFromString(fields[i]);
+        break;
+      default:
+        tuple << fields[i];
+        break;
+    }
+  }
+  relation->insert(tuple);
+}
+
 //------------------------------------------------------------------------------
 // Assertions
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Value.h>
 #include <souffle/SouffleInterface.h>
@@ -12,73 +13,136 @@
 #include <string>
 #include <thread>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
-enum PAFlags { NONE = 0, WRITE_ALL = 1 << 0 };
+#include "AllocationId.h"
+#include "FactSink.hpp"
+#include "ValueTable.hpp"
+
+enum PAFlags {
+  NONE = 0,
+  WRITE_ALL = 1 << 0,
+  FACTS_IN_MEMORY = 1 << 1,
+  FACTS_INTERNED = 1 << 2
+};
 inline constexpr auto operator|(PAFlags lhs, PAFlags rhs) -> PAFlags {
   return static_cast<PAFlags>(static_cast<int>(lhs) | static_cast<int>(rhs));
 }
 
+//------------------------------------------------------------------------------
+// Symbols
+
+// Resolves the symbols of a Souffle program to the values, allocations and
+// interned strings that they stand for. Each symbol is only decoded and looked
+// up the first time it's resolved, and then found by its ID.
+class SymbolResolver {
+ public:
+  SymbolResolver(
+      const souffle::SymbolTable &symbols,
+      const cclyzer::ValueTable &llvm_val_map)
+      : symbols_(symbols), llvm_val_map_(llvm_val_map) {}
+
+  // Value whose refmode is the given symbol. Exits if there is none.
+  auto value(souffle::RamDomain symbol) -> const llvm::Value *;
+
+  // Allocation whose name is the given symbol
+  auto allocation(souffle::RamDomain symbol) -> cclyzer::AllocationId;
+
+  // Name of an allocation returned by allocation()
+  [[nodiscard]] auto allocationName(cclyzer::AllocationId alloc) const
+      -> const std::string & {
+    return *allocation_names_[static_cast<std::size_t>(alloc)];
+  }
+
+  // Interned string of the given symbol
+  auto string(souffle::RamDomain symbol) -> boost::flyweight<std::string>;
+
+  [[nodiscard]] auto decode(souffle::RamDomain symbol) const
+      -> const std::string & {
+    return symbols_.decode(symbol);
+  }
+
+ private:
+  const souffle::SymbolTable &symbols_;
+  const cclyzer::ValueTable &llvm_val_map_;
+
+  // Resolved symbols, by ID. Results only refer to some of the symbols, so
+  // these are sparse.
+  llvm::DenseMap<souffle::RamDomain, const llvm::Value *> values_;
+  llvm::DenseMap<souffle::RamDomain, cclyzer::AllocationId> allocations_;
+  llvm::DenseMap<souffle::RamDomain, boost::flyweight<std::string>> strings_;
+
+  // Names of allocations, by allocation. These belong to the symbol table.
+  std::vector<const std::string *> allocation_names_;
+};
+
 //------------------------------------------------------------------------------
 // Templates
 
-// Extract a single element of type T from this tuple/row.
+// Extract a single element of type T from this field of a tuple/row.
 template <class T>
-auto extract_from_row(
-    souffle::tuple &row,
-    const std::map<boost::flyweight<std::string>, const llvm::Value *>
-        &llvm_val_map) -> T {
+auto extract_from_row(souffle::RamDomain field, SymbolResolver &symbols)
+    -> T {
   if constexpr (std::is_same<T, int>::value) {
-    int t0;
-    row >> t0;
-    return t0;
+    return static_cast<int>(field);
+  } else if constexpr (std::is_same<T, const llvm::Value *>::value) {
+    return symbols.value(field);
+  } else if constexpr (std::is_same<T, cclyzer::AllocationId>::value) {
+    return symbols.allocation(field);
+  } else if constexpr (std::is_same<T, boost::flyweight<std::string>>::
+                           value) {
+    return symbols.string(field);
   } else {  // NOLINT: clang-tidy doesn't know about "if constexpr"
-    std::string t0;
-    row >> t0;
-    if constexpr (std::is_same<T, const llvm::Value *>::value) {
-      try {
-        return llvm_val_map.at(boost::flyweight<std::string>(t0));
-      } catch (const std::out_of_range &) {
-        std::cout << "Failed value* lookup: " << t0 << std::endl;
-        exit(EXIT_FAILURE);
-      }
-    } else if constexpr (std::is_same<T, boost::flyweight<std::string>>::
-                             value) {
-      return boost::flyweight<std::string>(t0);
-    } else {
-      return t0;
-    }
+    return symbols.decode(field);
   }
 }
 
-template <typename T, typename... Ts>
+template <typename... Ts, std::size_t... Is>
 auto extract_row(
-    souffle::tuple &row,
-    const std::map<boost::flyweight<std::string>, const llvm::Value *>
-        &llvm_val_map) -> std::tuple<T, Ts...> {
-  auto t = extract_from_row<T>(row, llvm_val_map);
-  if constexpr (sizeof...(Ts) == 0) {
-    return std::make_tuple(t);
-  } else {  // NOLINT: clang-tidy doesn't know about "if constexpr"
-    return std::tuple_cat(
-        std::make_tuple(t), extract_row<Ts...>(row, llvm_val_map));
-  }
+    const souffle::tuple &row,
+    SymbolResolver &symbols,
+    std::index_sequence<Is...> /*fields*/) -> std::tuple<Ts...> {
+  return {extract_from_row<Ts>(row[Is], symbols)...};
 }
 
 template <typename T, typename... Ts>
-auto relation_to_vector(
-    const souffle::Relation *rel,
-    const std::map<boost::flyweight<std::string>, const llvm::Value *>
-        &llvm_val_map) -> std::vector<std::tuple<T, Ts...>> {
+auto relation_to_vector(const souffle::Relation *rel, SymbolResolver &symbols)
+    -> std::vector<std::tuple<T, Ts...>> {
   assert(rel != nullptr);
   assert(rel->getArity() == sizeof...(Ts) + 1);
   std::vector<std::tuple<T, Ts...>> vec;
-  for (auto &row : *rel) {
-    vec.push_back(extract_row<T, Ts...>(row, llvm_val_map));
+  vec.reserve(rel->size());
+  for (const auto &row : *rel) {
+    vec.push_back(extract_row<T, Ts...>(
+        row, symbols, std::index_sequence_for<T, Ts...>()));
   }
   return vec;
 }
 
+//------------------------------------------------------------------------------
+// Fact sink
+
+// Inserts facts straight into the input relations of a Souffle program, so that
+// they never have to be written to (and parsed back from) CSV files.
+class SouffleFactSink : public cclyzer::FactSink {
+ public:
+  explicit SouffleFactSink(souffle::SouffleProgram &program)
+      : program_(program) {}
+  ~SouffleFactSink() override = default;
+
+  void insert(const cclyzer::Predicate &, const std::vector<std::string> &)
+      override;
+
+ private:
+  auto getRelation(const cclyzer::Predicate &) -> souffle::Relation *;
+
+  souffle::SouffleProgram &program_;
+
+  // Input relations, indexed by predicate index
+  std::vector<souffle::Relation *> relations_;
+};
+
 //------------------------------------------------------------------------------
 // Interface
 
@@ -87,8 +151,15 @@ class PAInterface {
   static auto create(const std::string &) -> std::unique_ptr<PAInterface>;
   ~PAInterface();
 
+  // Create a sink that inserts facts directly into this instance. Facts
+  // written to the sink are only picked up by runPointerAnalysis if
+  // FACTS_IN_MEMORY is set.
+  auto createFactSink() -> std::unique_ptr<cclyzer::FactSink>;
+
   // Main entry point for the pointer analysis.  Assumes facts have been
-  // generated, and so calls out to Souffle to run on them.
+  // generated, and so calls out to Souffle to run on them. Unless
+  // FACTS_IN_MEMORY is set, the facts are loaded from the given directory. If
+  // FACTS_INTERNED is set, they are read as IDs of interned symbols.
   auto runPointerAnalysis(const boost::filesystem::path &, const PAFlags)
       -> int;
 
@@ -101,19 +172,28 @@ class PAInterface {
 
   // Getters for the various kinds of results we support
 
+  // Resolver of the symbols in results to the given values. Share one between
+  // calls to relationToVector, so that each symbol is only resolved once.
+  auto symbolResolver(const cclyzer::ValueTable &llvm_val_map) const
+      -> SymbolResolver {
+    return {souffle_program_->getSymbolTable(), llvm_val_map};
+  }
+
   template <typename T, typename... Ts>
-  auto relationToVector(
-      const std::string &relation,
-      const std::map<boost::flyweight<std::string>, const llvm::Value *>
-          &llvm_val_map) const -> std::vector<std::tuple<T, Ts...>> {
+  auto relationToVector(const std::string &relation, SymbolResolver &symbols)
+      const -> std::vector<std::tuple<T, Ts...>> {
     return relation_to_vector<T, Ts...>(
-        souffle_program_->getRelation(relation), llvm_val_map);
+        souffle_program_->getRelation(relation), symbols);
   }
 
  private:
   // The Souffle data
   explicit PAInterface(souffle::SouffleProgram *);
 
+  // Insert facts that refer to interned symbols, see FactWriter, from the
+  // given directory. Throws std::runtime_error on malformed facts.
+  void loadInternedFacts(const boost::filesystem::path &);
+
   //------------------------------------------------------------------------------
   // Variables
 
@@ -1,12 +1,20 @@
 #include "PointerAnalysis.h"
 
+#include <algorithm>
 #include <boost/filesystem.hpp>
 #include <boost/flyweight.hpp>
-#include <unordered_set>
+#include <chrono>
+#include <mutex>
 
 #include "PAInterface.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/IR/InstIterator.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
 
 // Legacy pass manager
 #include "llvm/Pass.h"
@@ -48,11 +56,36 @@ static llvm::cl::opt<std::string> datalog_debug_dir_option(
     llvm::cl::desc("Where to keep intermediate files generated by datalog"),
     llvm::cl::init((fs::temp_directory_path() / fs::unique_path()).native()));
 
+static llvm::cl::opt<bool> in_memory_facts_option(
+    "in-memory-facts",
+    llvm::cl::desc(
+        "Insert facts directly into Souffle instead of writing fact files"),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<bool> intern_fact_symbols_option(
+    "intern-fact-symbols",
+    llvm::cl::desc(
+        "Write symbols once, and refer to them by ID in fact files (no effect "
+        "with -in-memory-facts)"),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<int> fact_compression_level_option(
+    "fact-compression-level",
+    llvm::cl::desc("Compression level of fact files (-1 for the default)"),
+    llvm::cl::init(DEFAULT_COMPRESSION_LEVEL));
+
 static llvm::cl::opt<bool> datalog_check_assertions_option(
     "check-datalog-assertions",
     llvm::cl::desc("Check assertions in the datalog code"),
     llvm::cl::init(false));
 
+static llvm::cl::opt<std::string> alias_query_trace_option(
+    "alias-query-trace",
+    llvm::cl::desc(
+        "Time the alias queries printed by opt -aa-eval "
+        "-print-all-alias-modref-info (in the given file) on the results"),
+    llvm::cl::init(""));
+
 static llvm::cl::opt<std::string> signatures(
     "signatures", llvm::cl::desc("File with points-to signatures"));
 
@@ -80,6 +113,14 @@ static llvm::cl::opt<ContextSensitivity> context_sensitivity(
         clEnumValN(CALLER8, CALLER8_STRING, "depth 8 caller sensitive"),
         clEnumValN(CALLER9, CALLER9_STRING, "depth 9 caller sensitive")));
 
+// Must match the fact files that the Datalog code reads, which is decided at
+// build time, see FACTS_COMPRESSION in CMakeLists.txt
+#ifdef FACTS_UNCOMPRESSED
+constexpr Compression fact_compression = Compression::NONE;
+#else
+constexpr Compression fact_compression = Compression::GZIP;
+#endif
+
 auto PointerAnalysisAAResult::alias(
     const llvm::MemoryLocation &location,
     const llvm::MemoryLocation &other_location,
@@ -92,41 +133,140 @@ auto PointerAnalysisAAResult::alias(
 #endif
   }
 
-  std::unordered_set<boost::flyweight<std::string>> points_to_set;
-  std::unordered_set<boost::flyweight<std::string>> other_points_to_set;
-  for (const auto &tuple : variable_points_to_) {
-    const auto &to = std::get<1>(tuple);
-    const auto from = std::get<3>(tuple);
-    if (from == location.Ptr) {
-      if (other_points_to_set.find(to) != other_points_to_set.end()) {
+  if (pointsToOverlap(location.Ptr, other_location.Ptr)) {
 #if LLVM_VERSION_MAJOR > 15
-        return llvm::AAResultBase::alias(location, other_location, AAQI);
+    return llvm::AAResultBase::alias(location, other_location, AAQI);
 #else
-        return AAResultBase::alias(location, other_location, AAQI);
+    return AAResultBase::alias(location, other_location, AAQI);
 #endif
-      }
-
-      points_to_set.insert(to);
-    }
+  }
 
-    if (from == other_location.Ptr) {
-      if (points_to_set.find(to) != points_to_set.end()) {
-#if LLVM_VERSION_MAJOR > 15
-        return llvm::AAResultBase::alias(location, other_location, AAQI);
+#if LLVM_VERSION_MAJOR > 12
+  return llvm::AliasResult::NoAlias;
 #else
-        return AAResultBase::alias(location, other_location, AAQI);
+  return llvm::NoAlias;
 #endif
+}
+
+auto PointerAnalysisAAResult::pointsToOverlap(
+    const llvm::Value *value, const llvm::Value *other_value) const -> bool {
+  auto small = getPointsToSet(value);
+  auto large = getPointsToSet(other_value);
+  if (small.size() > large.size()) {
+    std::swap(small, large);
+  }
+
+  // Look up each allocation of a much smaller set in the larger one, and
+  // otherwise walk both sets at once
+  if (small.size() * 16 < large.size()) {
+    return std::any_of(small.begin(), small.end(), [&](AllocationId alloc) {
+      return std::binary_search(large.begin(), large.end(), alloc);
+    });
+  }
+  const auto *it = small.begin();
+  const auto *other_it = large.begin();
+  while (it != small.end() && other_it != large.end()) {
+    if (*it == *other_it) {
+      return true;
+    }
+    if (*it < *other_it) {
+      ++it;
+    } else {
+      ++other_it;
+    }
+  }
+  return false;
+}
+
+// Replay the alias queries of a trace printed by opt -aa-eval
+// -print-all-alias-modref-info on the given results, and report how long they
+// took. Queries about pointers that aren't in the module are skipped.
+static void replay_alias_queries(
+    const llvm::Module &mod,
+    const PointerAnalysisAAResult &result,
+    const std::string &path) {
+  auto trace = llvm::MemoryBuffer::getFile(path);
+  if (!trace) {
+    llvm::errs() << "Can't read alias query trace " << path << ": "
+                 << trace.getError().message() << "\n";
+    return;
+  }
+
+  // Pointers of the current function, as printed by aa-eval
+  llvm::StringMap<const llvm::Value *> pointers;
+  const auto add_pointer = [&](const llvm::Value &value) {
+    if (!value.getType()->isPointerTy()) {
+      return;
+    }
+    std::string printed;
+    llvm::raw_string_ostream out(printed);
+    value.getType()->print(out, false, true);
+    out << ' ';
+    value.printAsOperand(out, false, &mod);
+    pointers.try_emplace(out.str(), &value);
+  };
+
+  std::vector<std::pair<const llvm::Value *, const llvm::Value *>> queries;
+  std::size_t skipped = 0;
+  llvm::SmallVector<llvm::StringRef, 0> lines;
+  trace.get()->getBuffer().split(lines, '\n');
+  for (llvm::StringRef line : lines) {
+    // Function: <name>: <n> pointers, <n> call sites
+    if (line.consume_front("Function: ")) {
+      pointers.clear();
+      if (const auto *func = mod.getFunction(line.rsplit(": ").first)) {
+        for (const auto &arg : func->args()) {
+          add_pointer(arg);
+        }
+        for (const auto &instr : llvm::instructions(*func)) {
+          add_pointer(instr);
+          for (const auto &operand : instr.operands()) {
+            add_pointer(*operand);
+          }
+        }
       }
+      continue;
+    }
+
+    // <result>:<tab><pointer>, <pointer>
+    const auto [result_name, pair] = line.split('\t');
+    if (!result_name.trim().endswith(":") ||
+        !result_name.contains("Alias")) {
+      continue;
+    }
 
-      other_points_to_set.insert(to);
+    // Types may contain commas too, so try each split
+    bool found = false;
+    for (std::size_t pos = pair.find(", ");
+         pos != llvm::StringRef::npos && !found;
+         pos = pair.find(", ", pos + 1)) {
+      const auto first = pointers.find(pair.take_front(pos));
+      const auto second = pointers.find(pair.drop_front(pos + 2));
+      if (first != pointers.end() && second != pointers.end()) {
+        queries.emplace_back(first->second, second->second);
+        found = true;
+      }
+    }
+    if (!found) {
+      skipped++;
     }
   }
 
-#if LLVM_VERSION_MAJOR > 12
-  return llvm::AliasResult::NoAlias;
-#else
-  return llvm::NoAlias;
-#endif
+  std::size_t may_alias = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (const auto &[value, other_value] : queries) {
+    if (result.pointsToOverlap(value, other_value)) {
+      may_alias++;
+    }
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  llvm::errs() << "Replayed " << queries.size() << " alias queries ("
+               << may_alias << " may alias, " << skipped << " skipped) in "
+               << std::chrono::duration_cast<std::chrono::microseconds>(
+                      elapsed)
+                      .count()
+               << " us\n";
 }
 
 static auto get_interface(Analysis which) -> std::unique_ptr<PAInterface> {
@@ -237,6 +377,30 @@ static auto var_points_to(Analysis which) -> std::string {
   assert(false && "unreachable");
 }
 
+static auto stripctx_var_points_to(Analysis which) -> std::string {
+  switch (which) {
+    case Analysis::DEBUG:
+      [[fallthrough]];
+    case Analysis::SUBSET:
+      return "subset.stripctx.stripctx_var_points_to";
+    case Analysis::UNIFICATION:
+      return "unification.stripctx_final.stripctx_var_points_to";
+  }
+  assert(false && "unreachable");
+}
+
+static auto stripctx_ptr_points_to(Analysis which) -> std::string {
+  switch (which) {
+    case Analysis::DEBUG:
+      [[fallthrough]];
+    case Analysis::SUBSET:
+      return "subset.stripctx.stripctx_ptr_points_to";
+    case Analysis::UNIFICATION:
+      return "unification.stripctx_final.stripctx_ptr_points_to";
+  }
+  assert(false && "unreachable");
+}
+
 static auto allocation_size(Analysis which) -> std::string {
   switch (which) {
     case Analysis::DEBUG:
@@ -261,9 +425,253 @@ static auto allocation_by_instr(Analysis which) -> std::string {
   assert(false && "unreachable");
 }
 
+//------------------------------------------------------------------------------
+// Results
+
+struct PointerAnalysisAAResult::Source {
+  Source(
+      std::unique_ptr<PAInterface> interface,
+      ValueTable values,
+      Analysis analysis)
+      : pa(std::move(interface)),
+        llvm_val_map(std::move(values)),
+        symbols(pa->symbolResolver(llvm_val_map)),
+        which(analysis) {}
+
+  // A relation, or something derived from relations, computed on first use
+  template <typename T>
+  struct Lazy {
+    std::once_flag once;
+    T value;
+  };
+
+  // Compute the value of the given cache with fill, unless it already was.
+  // Waits for another thread that is already computing it.
+  template <typename T, typename F>
+  static auto get(Lazy<T> &cache, F fill) -> const T & {
+    std::call_once(cache.once, [&] { cache.value = fill(); });
+    return cache.value;
+  }
+
+  // Read a relation of the results into the given cache, unless it already
+  // was
+  template <typename T, typename... Ts>
+  auto read(
+      Lazy<std::vector<std::tuple<T, Ts...>>> &cache,
+      const std::string &relation)
+      -> const std::vector<std::tuple<T, Ts...>> & {
+    return get(cache, [&] { return readVector<T, Ts...>(relation); });
+  }
+
+  // Read a relation, resolving its symbols
+  template <typename T, typename... Ts>
+  auto readVector(const std::string &relation)
+      -> std::vector<std::tuple<T, Ts...>> {
+    std::lock_guard<std::mutex> lock(symbols_mutex);
+    return pa->relationToVector<T, Ts...>(relation, symbols);
+  }
+
+  std::unique_ptr<PAInterface> pa;
+  ValueTable llvm_val_map;
+
+  // Symbols are resolved lazily too, so only one relation is read at a time
+  SymbolResolver symbols;
+  std::mutex symbols_mutex;
+
+  Analysis which;
+
+  // Relations read so far
+  Lazy<context_to_string_t> context_to_string;
+  Lazy<var_points_to_t> variable_points_to;
+  Lazy<alloc_relation_t> alloc_may_alias;
+  Lazy<alloc_relation_t> alloc_must_alias;
+  Lazy<alloc_relation_t> alloc_subregion;
+  Lazy<alloc_relation_t> alloc_contains;
+  Lazy<ptr_points_to_t> pointer_points_to;
+  Lazy<var_points_to_t> operand_points_to;
+  Lazy<global_allocations_t> global_allocations;
+  Lazy<allocation_sizes_t> allocation_sizes;
+  Lazy<allocation_sites_t> allocation_sites;
+  Lazy<stripctx_var_points_to_t> stripctx_var_points_to;
+  Lazy<stripctx_ptr_points_to_t> stripctx_ptr_points_to;
+  Lazy<std::set<const llvm::Value *>> null_ptr_set;
+  Lazy<callgraph_t> callgraph;
+
+  // Allocations that each value points to in any context, sorted
+  Lazy<llvm::DenseMap<const llvm::Value *, std::vector<AllocationId>>>
+      points_to_index;
+};
+
+PointerAnalysisAAResult::PointerAnalysisAAResult(
+    std::unique_ptr<PAInterface> pa,
+    ValueTable llvm_val_map,
+    Analysis which)
+    : source_(std::make_shared<Source>(
+          std::move(pa), std::move(llvm_val_map), which)) {}
+
+auto PointerAnalysisAAResult::getPointsToSet(const llvm::Value *value) const
+    -> llvm::ArrayRef<AllocationId> {
+  const auto &index = Source::get(source_->points_to_index, [this] {
+    llvm::DenseMap<const llvm::Value *, std::vector<AllocationId>> index;
+    for (const auto &[alloc, pointer] : getStripCtxVarPointsTo()) {
+      index[pointer].push_back(alloc);
+    }
+
+    // The projection has no duplicates, but is ordered by symbol
+    for (auto &entry : index) {
+      auto &allocs = entry.second;
+      std::sort(allocs.begin(), allocs.end());
+      allocs.shrink_to_fit();
+    }
+    return index;
+  });
+
+  const auto found = index.find(value);
+  if (found == index.end()) {
+    return {};
+  }
+  return found->second;
+}
+
+auto PointerAnalysisAAResult::getContextToString() const
+    -> const context_to_string_t & {
+  return Source::get(source_->context_to_string, [this] {
+    context_to_string_t context_to_string;
+    for (const auto &[fst, snd] :
+         source_->readVector<int, boost::flyweight<std::string>>(
+             "context_to_string")) {
+      context_to_string.emplace(fst, snd);
+    }
+    return context_to_string;
+  });
+}
+
+auto PointerAnalysisAAResult::getVariablePointsTo() const
+    -> const var_points_to_t & {
+  return source_->read(
+      source_->variable_points_to, var_points_to(source_->which));
+}
+
+auto PointerAnalysisAAResult::getPointerPointsTo() const
+    -> const ptr_points_to_t & {
+  return source_->read(
+      source_->pointer_points_to, ptr_points_to(source_->which));
+}
+
+auto PointerAnalysisAAResult::getAllocMayAlias() const
+    -> const alloc_relation_t & {
+  return source_->read(
+      source_->alloc_may_alias, alloc_may_alias(source_->which));
+}
+
+auto PointerAnalysisAAResult::getAllocMustAlias() const
+    -> const alloc_relation_t & {
+  return source_->read(
+      source_->alloc_must_alias, alloc_must_alias(source_->which));
+}
+
+auto PointerAnalysisAAResult::getAllocSubregion() const
+    -> const alloc_relation_t & {
+  return source_->read(
+      source_->alloc_subregion, alloc_subregion(source_->which));
+}
+
+auto PointerAnalysisAAResult::getAllocContains() const
+    -> const alloc_relation_t & {
+  return source_->read(
+      source_->alloc_contains, alloc_contains(source_->which));
+}
+
+auto PointerAnalysisAAResult::getOperandPointsTo() const
+    -> const var_points_to_t & {
+  return source_->read(
+      source_->operand_points_to, operand_points_to(source_->which));
+}
+
+auto PointerAnalysisAAResult::getGlobalAllocations() const
+    -> const global_allocations_t & {
+  return source_->read(
+      source_->global_allocations, "global_allocation_by_variable");
+}
+
+auto PointerAnalysisAAResult::getAllocationSizes() const
+    -> const allocation_sizes_t & {
+  return source_->read(
+      source_->allocation_sizes, allocation_size(source_->which));
+}
+
+auto PointerAnalysisAAResult::getAllocationSites() const
+    -> const allocation_sites_t & {
+  return source_->read(
+      source_->allocation_sites, allocation_by_instr(source_->which));
+}
+
+auto PointerAnalysisAAResult::getStripCtxVarPointsTo() const
+    -> const stripctx_var_points_to_t & {
+  return source_->read(
+      source_->stripctx_var_points_to,
+      stripctx_var_points_to(source_->which));
+}
+
+auto PointerAnalysisAAResult::getStripCtxPtrPointsTo() const
+    -> const stripctx_ptr_points_to_t & {
+  return source_->read(
+      source_->stripctx_ptr_points_to,
+      stripctx_ptr_points_to(source_->which));
+}
+
+auto PointerAnalysisAAResult::getNullPtrSet() const
+    -> const std::set<const llvm::Value *> & {
+  return Source::get(source_->null_ptr_set, [this] {
+    std::set<const llvm::Value *> null_ptr_set;
+    for (const auto &[alias_set_identifier, value] : getStripCtxVarPointsTo()) {
+      // *null* is the null_location in the Datalog code.
+      if (getAllocationName(alias_set_identifier) == "*null*") {
+        null_ptr_set.emplace(value);
+      }
+    }
+    return null_ptr_set;
+  });
+}
+
+auto PointerAnalysisAAResult::getAllocationName(AllocationId alloc) const
+    -> const std::string & {
+  // Names are added as relations are read
+  std::lock_guard<std::mutex> lock(source_->symbols_mutex);
+  return source_->symbols.allocationName(alloc);
+}
+
+auto PointerAnalysisAAResult::getCallGraph() const -> const callgraph_t & {
+  return Source::get(source_->callgraph, [this] {
+    callgraph_t callgraph;
+    for (const auto &[callee_ctx, callee, caller_ctx, caller] :
+         source_->readVector<
+             int,
+             const llvm::Value *,
+             int,
+             const llvm::Value *>(callgraph_edge(source_->which))) {
+      std::tuple<int, int, const llvm::Value *> entry(
+          caller_ctx, callee_ctx, callee);
+      callgraph.emplace(caller, entry);
+    }
+    return callgraph;
+  });
+}
+
 auto LegacyPointerAnalysis::runOnModule(llvm::Module &mod) -> bool {
+  if (!valid_compression_level(
+          fact_compression, fact_compression_level_option)) {
+    llvm::report_fatal_error(
+        "Invalid -fact-compression-level " +
+            llvm::Twine(fact_compression_level_option) + " for " +
+            compression_string(fact_compression) + ", expected " +
+            compression_levels(fact_compression),
+        false);
+  }
+
   const fs::path output_dir = fs::path(datalog_debug_dir_option);
-  if (!fs::exists(output_dir)) {
+  if ((!in_memory_facts_option || datalog_debug_option) &&
+      !fs::exists(output_dir)) {
     fs::create_directories(output_dir);
   }
 
@@ -274,99 +682,43 @@ auto LegacyPointerAnalysis::runOnModule(llvm::Module &mod) -> bool {
     signatures_path = llvm::Optional<fs::path>();
   }
 
-  auto [dir, llvm_val_map] =
-      factgen_module(mod, output_dir, signatures_path, context_sensitivity);
-  const auto pa = get_interface(datalog_analysis);
+  auto pa = get_interface(datalog_analysis);
   PAFlags flags = PAFlags::NONE;
   if (datalog_debug_option) {
     flags = flags | PAFlags::WRITE_ALL;
   }
 
+  fs::path dir = output_dir;
+  cclyzer::ValueTable llvm_val_map;
+  if (in_memory_facts_option) {
+    const auto sink = pa->createFactSink();
+    llvm_val_map =
+        factgen_module(mod, *sink, signatures_path, context_sensitivity);
+    flags = flags | PAFlags::FACTS_IN_MEMORY;
+  } else {
+    std::tie(dir, llvm_val_map) = factgen_module(
+        mod,
+        output_dir,
+        signatures_path,
+        context_sensitivity,
+        fact_compression,
+        fact_compression_level_option,
+        intern_fact_symbols_option);
+    if (intern_fact_symbols_option) {
+      flags = flags | PAFlags::FACTS_INTERNED;
+    }
+  }
+
   pa->runPointerAnalysis(dir, flags);
   if (datalog_check_assertions_option) {
     pa->checkAssertions(datalog_analysis == Analysis::DEBUG);
   }
 
-  std::map<int, boost::flyweight<std::string>> context_to_string;
-  const auto context_to_string_vec =
-      pa->relationToVector<int, boost::flyweight<std::string>>(
-          "context_to_string", llvm_val_map);
-  for (const auto &[fst, snd] : context_to_string_vec) {
-    context_to_string.emplace(fst, snd);
-  }
-
-  std::multimap<const llvm::Value *, std::tuple<int, int, const llvm::Value *>>
-      call_graph;
-  const auto callgraph_vec =
-      pa->relationToVector<int, const llvm::Value *, int, const llvm::Value *>(
-          callgraph_edge(datalog_analysis), llvm_val_map);
-  for (const auto &[callee_ctx, callee, caller_ctx, caller] : callgraph_vec) {
-    std::tuple<int, int, const llvm::Value *> entry(
-        caller_ctx, callee_ctx, callee);
-    call_graph.emplace(caller, entry);
-  }
-
-  std::set<const llvm::Value *> null_ptr_set;
-  auto var_points_to_rel = pa->relationToVector<
-      int,
-      boost::flyweight<std::string>,
-      int,
-      const llvm::Value *>(var_points_to(datalog_analysis), llvm_val_map);
-  for (const auto &[_alloc_ctx, alias_set_identifier, _pointer_ctx, value] :
-       var_points_to_rel) {
-    // *null* is the null_location in the Datalog code.
-    if (alias_set_identifier == "*null*") {
-      null_ptr_set.emplace(value);
-    }
-  }
-
   result_ = std::make_unique<PointerAnalysisAAResult>(
-      std::move(context_to_string),
-      std::move(var_points_to_rel),
-      pa->relationToVector<
-          int,
-          boost::flyweight<std::string>,
-          boost::flyweight<std::string>>(
-          alloc_may_alias(datalog_analysis), llvm_val_map),
-      pa->relationToVector<
-          int,
-          boost::flyweight<std::string>,
-          boost::flyweight<std::string>>(
-          alloc_must_alias(datalog_analysis), llvm_val_map),
-      pa->relationToVector<
-          int,
-          boost::flyweight<std::string>,
-          boost::flyweight<std::string>>(
-          alloc_subregion(datalog_analysis), llvm_val_map),
-      pa->relationToVector<
-          int,
-          boost::flyweight<std::string>,
-          boost::flyweight<std::string>>(
-          alloc_contains(datalog_analysis), llvm_val_map),
-      pa->relationToVector<
-          int,
-          boost::flyweight<std::string>,
-          int,
-          boost::flyweight<std::string>>(
-          ptr_points_to(datalog_analysis), llvm_val_map),
-      pa->relationToVector<
-          int,
-          boost::flyweight<std::string>,
-          int,
-          const llvm::Value *>(
-          operand_points_to(datalog_analysis), llvm_val_map),
-      pa->relationToVector<const llvm::Value *, boost::flyweight<std::string>>(
-          "global_allocation_by_variable", llvm_val_map),
-      pa->relationToVector<int, boost::flyweight<std::string>, int>(
-          allocation_size(datalog_analysis), llvm_val_map),
-      pa->relationToVector<
-          int,
-          const llvm::Value *,
-          int,
-          boost::flyweight<std::string>>(
-          allocation_by_instr(datalog_analysis), llvm_val_map),
-      std::move(null_ptr_set),
-      std::move(call_graph));
+      std::move(pa), std::move(llvm_val_map), datalog_analysis);
+  if (!alias_query_trace_option.empty()) {
+    replay_alias_queries(mod, *result_, alias_query_trace_option);
+  }
   if (!datalog_debug_option) {
     boost::filesystem::remove_all(dir);
   }
@@ -377,7 +729,7 @@ auto PointerAnalysis::run(llvm::Module &module, llvm::ModuleAnalysisManager &)
     -> PointerAnalysis::Result {
   LegacyPointerAnalysis legacy_pa;
   legacy_pa.runOnModule(module);
-  return legacy_pa.getResult();
+  return std::move(legacy_pa.getResult());
 }
 
 // Modern pass manager registration
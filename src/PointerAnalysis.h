@@ -3,17 +3,24 @@
 
 #include <boost/flyweight.hpp>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "AllocationId.h"
+#include "ValueTable.hpp"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Value.h"
 #include "llvm/Support/CommandLine.h"
 
+class PAInterface;
+enum class Analysis;
+
 namespace cclyzer {
 
 class PointerAnalysisAAResult
@@ -26,196 +33,84 @@ class PointerAnalysisAAResult
 #endif
 
  public:
-  explicit PointerAnalysisAAResult(
-      const std::map<int, boost::flyweight<std::string>>&& context_to_string,
-      const std::vector<std::tuple<
-          int,
-          boost::flyweight<std::string>,
-          int,
-          const llvm::Value*>>&& variable_points_to,
-      const std::vector<std::tuple<
-          int,
-          boost::flyweight<std::string>,
-          boost::flyweight<std::string>>>&& alloc_may_alias,
-      const std::vector<std::tuple<
-          int,
-          boost::flyweight<std::string>,
-          boost::flyweight<std::string>>>&& alloc_must_alias,
-      const std::vector<std::tuple<
-          int,
-          boost::flyweight<std::string>,
-          boost::flyweight<std::string>>>&& alloc_subregion,
-      const std::vector<std::tuple<
-          int,
-          boost::flyweight<std::string>,
-          boost::flyweight<std::string>>>&& alloc_contains,
-      const std::vector<std::tuple<
-          int,
-          boost::flyweight<std::string>,
-          int,
-          boost::flyweight<std::string>>>&& pointer_points_to,
-      const std::vector<std::tuple<
-          int,
-          boost::flyweight<std::string>,
-          int,
-          const llvm::Value*>>&& operand_points_to,
-      const std::vector<
-          std::tuple<const llvm::Value*, boost::flyweight<std::string>>>&&
-          global_allocations,
-      const std::vector<std::tuple<int, boost::flyweight<std::string>, int>>&&
-          allocation_sizes,
-      const std::vector<std::tuple<
-          int,
-          const llvm::Value*,
-          int,
-          boost::flyweight<std::string>>>&& allocation_sites,
-      const std::set<const llvm::Value*>&& null_ptr_set,
-      const std::multimap<
-          const llvm::Value*,
-          std::tuple<int, int, const llvm::Value*>>&& callgraph)
-      : context_to_string_(context_to_string),
-        variable_points_to_(variable_points_to),
-        alloc_may_alias_(alloc_may_alias),
-        alloc_must_alias_(alloc_must_alias),
-        alloc_subregion_(alloc_subregion),
-        alloc_contains_(alloc_contains),
-        pointer_points_to_(pointer_points_to),
-        operand_points_to_(operand_points_to),
-        global_allocations_(global_allocations),
-        allocation_sizes_(allocation_sizes),
-        allocation_sites_(allocation_sites),
-        null_ptr_set_(null_ptr_set),
-        callgraph_(callgraph) {}
+  using context_to_string_t = std::map<int, boost::flyweight<std::string>>;
+  // Points-to sets of variables or operands
+  using var_points_to_t =
+      std::vector<std::tuple<int, AllocationId, int, const llvm::Value*>>;
+  // Relations between pairs of allocations
+  using alloc_relation_t =
+      std::vector<std::tuple<int, AllocationId, AllocationId>>;
+  using ptr_points_to_t =
+      std::vector<std::tuple<int, AllocationId, int, AllocationId>>;
+  using global_allocations_t =
+      std::vector<std::tuple<const llvm::Value*, AllocationId>>;
+  using allocation_sizes_t = std::vector<std::tuple<int, AllocationId, int>>;
+  using allocation_sites_t =
+      std::vector<std::tuple<int, const llvm::Value*, int, AllocationId>>;
+  // Context-insensitive projections of var_points_to and ptr_points_to, with
+  // the allocation pointed to first, and without duplicates
+  using stripctx_var_points_to_t =
+      std::vector<std::tuple<AllocationId, const llvm::Value*>>;
+  using stripctx_ptr_points_to_t =
+      std::vector<std::tuple<AllocationId, AllocationId>>;
+  using callgraph_t = std::
+      multimap<const llvm::Value*, std::tuple<int, int, const llvm::Value*>>;
+
+  // Results of the given analysis, which must have been run, about the values
+  // of the given table. Relations are only read from the Souffle program when
+  // they're first asked for, and the program is kept until then. Getters may
+  // be called from several threads at once.
+  PointerAnalysisAAResult(
+      std::unique_ptr<PAInterface> pa,
+      cclyzer::ValueTable llvm_val_map,
+      Analysis which);
 
   auto alias(
       const llvm::MemoryLocation&,
       const llvm::MemoryLocation&,
       llvm::AAQueryInfo&) -> llvm::AliasResult;
 
-  auto getContextToString()
-      -> const std::map<int, boost::flyweight<std::string>>& {
-    return context_to_string_;
-  }
-
-  auto getVariablePointsTo() -> const std::vector<
-      std::
-          tuple<int, boost::flyweight<std::string>, int, const llvm::Value*>>& {
-    return variable_points_to_;
-  }
-
-  auto getPointerPointsTo() -> const std::vector<std::tuple<
-      int,
-      boost::flyweight<std::string>,
-      int,
-      boost::flyweight<std::string>>>& {
-    return pointer_points_to_;
-  }
-
-  auto getAllocMayAlias() -> const std::vector<std::tuple<
-      int,
-      boost::flyweight<std::string>,
-      boost::flyweight<std::string>>>& {
-    return alloc_may_alias_;
-  }
-
-  auto getAllocMustAlias() -> const std::vector<std::tuple<
-      int,
-      boost::flyweight<std::string>,
-      boost::flyweight<std::string>>>& {
-    return alloc_must_alias_;
-  }
-
-  auto getAllocSubregion() -> const std::vector<std::tuple<
-      int,
-      boost::flyweight<std::string>,
-      boost::flyweight<std::string>>>& {
-    return alloc_subregion_;
-  }
-
-  auto getAllocContains() -> const std::vector<std::tuple<
-      int,
-      boost::flyweight<std::string>,
-      boost::flyweight<std::string>>>& {
-    return alloc_contains_;
-  }
-
-  auto getOperandPointsTo() -> const std::vector<
-      std::
-          tuple<int, boost::flyweight<std::string>, int, const llvm::Value*>>& {
-    return operand_points_to_;
-  }
-
-  auto getGlobalAllocations() -> const std::vector<
-      std::tuple<const llvm::Value*, boost::flyweight<std::string>>>& {
-    return global_allocations_;
-  }
-
-  auto getAllocationSizes() -> const
-      std::vector<std::tuple<int, boost::flyweight<std::string>, int>>& {
-    return allocation_sizes_;
-  }
-
-  auto getAllocationSites() -> const std::vector<
-      std::
-          tuple<int, const llvm::Value*, int, boost::flyweight<std::string>>>& {
-    return allocation_sites_;
-  }
-
-  auto getNullPtrSet() -> const std::set<const llvm::Value*>& {
-    return null_ptr_set_;
-  }
-
-  auto getCallGraph() -> const std::
-      multimap<const llvm::Value*, std::tuple<int, int, const llvm::Value*>>& {
-    return callgraph_;
-  }
+  // Whether the two values point to a common allocation, in any contexts.
+  // Values that don't point to anything never do.
+  [[nodiscard]] auto pointsToOverlap(const llvm::Value*, const llvm::Value*)
+      const -> bool;
+
+  // Allocations that the value points to in any context, sorted
+  [[nodiscard]] auto getPointsToSet(const llvm::Value*) const
+      -> llvm::ArrayRef<AllocationId>;
+
+  [[nodiscard]] auto getContextToString() const -> const context_to_string_t&;
+  [[nodiscard]] auto getVariablePointsTo() const -> const var_points_to_t&;
+  [[nodiscard]] auto getPointerPointsTo() const -> const ptr_points_to_t&;
+  [[nodiscard]] auto getAllocMayAlias() const -> const alloc_relation_t&;
+  [[nodiscard]] auto getAllocMustAlias() const -> const alloc_relation_t&;
+  [[nodiscard]] auto getAllocSubregion() const -> const alloc_relation_t&;
+  [[nodiscard]] auto getAllocContains() const -> const alloc_relation_t&;
+  [[nodiscard]] auto getOperandPointsTo() const -> const var_points_to_t&;
+  [[nodiscard]] auto getGlobalAllocations() const
+      -> const global_allocations_t&;
+  [[nodiscard]] auto getAllocationSizes() const -> const allocation_sizes_t&;
+  [[nodiscard]] auto getAllocationSites() const -> const allocation_sites_t&;
+  [[nodiscard]] auto getStripCtxVarPointsTo() const
+      -> const stripctx_var_points_to_t&;
+  [[nodiscard]] auto getStripCtxPtrPointsTo() const
+      -> const stripctx_ptr_points_to_t&;
+  [[nodiscard]] auto getNullPtrSet() const
+      -> const std::set<const llvm::Value*>&;
+  [[nodiscard]] auto getCallGraph() const -> const callgraph_t&;
+
+  // Name of an allocation in any of the relations above
+  [[nodiscard]] auto getAllocationName(AllocationId) const
+      -> const std::string&;
 
  private:
-  const std::map<int, boost::flyweight<std::string>> context_to_string_;
-  const std::vector<
-      std::tuple<int, boost::flyweight<std::string>, int, const llvm::Value*>>
-      variable_points_to_;
-  const std::vector<std::tuple<
-      int,
-      boost::flyweight<std::string>,
-      boost::flyweight<std::string>>>
-      alloc_may_alias_;
-  const std::vector<std::tuple<
-      int,
-      boost::flyweight<std::string>,
-      boost::flyweight<std::string>>>
-      alloc_must_alias_;
-  const std::vector<std::tuple<
-      int,
-      boost::flyweight<std::string>,
-      boost::flyweight<std::string>>>
-      alloc_subregion_;
-  const std::vector<std::tuple<
-      int,
-      boost::flyweight<std::string>,
-      boost::flyweight<std::string>>>
-      alloc_contains_;
-  const std::vector<std::tuple<
-      int,
-      boost::flyweight<std::string>,
-      int,
-      boost::flyweight<std::string>>>
-      pointer_points_to_;
-  const std::vector<
-      std::tuple<int, boost::flyweight<std::string>, int, const llvm::Value*>>
-      operand_points_to_;
-  const std::vector<
-      std::tuple<const llvm::Value*, boost::flyweight<std::string>>>
-      global_allocations_;
-  const std::vector<std::tuple<int, boost::flyweight<std::string>, int>>
-      allocation_sizes_;
-  const std::vector<
-      std::tuple<int, const llvm::Value*, int, boost::flyweight<std::string>>>
-      allocation_sites_;
-  const std::set<const llvm::Value*> null_ptr_set_;
-  const std::
-      multimap<const llvm::Value*, std::tuple<int, int, const llvm::Value*>>
-          callgraph_;
+  // Souffle program of the analysis, the symbols of its results, and the
+  // relations read so far. Shared between copies of a result, so that it
+  // stays put when results are moved, and so that const getters can fill in
+  // its caches. The references that getters return point into it, so stay
+  // valid as long as any copy of the result does.
+  struct Source;
+  std::shared_ptr<Source> source_;
 };
 
 class PointerAnalysis : public llvm::AnalysisInfoMixin<PointerAnalysis> {
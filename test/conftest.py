@@ -8,7 +8,7 @@ from os import getenv
 from os.path import realpath
 from pathlib import Path
 from subprocess import check_call
-from typing import Any, Dict, Final, List, Tuple
+from typing import Any, Dict, Final, List, Optional, Tuple, Union
 from uuid import uuid4
 
 import pytest
@@ -104,6 +104,7 @@ def run(programs_path):
         program: str,
         context_sensitivity: str = "1-callsite",
         signatures: Dict = dict(),
+        pass_flags: Tuple[str, ...] = (),
         **kwargs: Any,
     ) -> Path:
         ir_path = _ir_for_program(programs_path / program, **kwargs)
@@ -131,6 +132,7 @@ def run(programs_path):
                 "-debug-datalog=true",
                 "-debug-datalog-dir={}".format(out_path),
                 "-context-sensitivity={}".format(context_sensitivity),
+                *pass_flags,
                 ir_path,
             ]
         )
@@ -147,6 +149,57 @@ def run(programs_path):
     return _run
 
 
+@pytest.fixture
+def bitcode(programs_path):
+    def _bitcode(program: Union[str, Path], **kwargs: Any) -> Path:
+        return _ir_for_program(programs_path / program, **kwargs)
+
+    return _bitcode
+
+
+@pytest.fixture
+def factgen(programs_path):
+    def _factgen(
+        program: Union[str, Path],
+        *args: str,
+        signatures: Optional[Dict] = None,
+        **kwargs: Any,
+    ) -> Path:
+        """Run the fact generator on a program (or on bitcode, see the bitcode
+        fixture), returning the directory of its (uncompressed) facts. Further
+        arguments are passed to factgen-exe."""
+        if Path(program).suffix == ".bc":
+            ir_path = Path(program)
+        else:
+            ir_path = _ir_for_program(programs_path / program, **kwargs)
+        out_path = ir_path.with_suffix(".{}.{}".format(str(uuid4())[:8], "facts"))
+
+        signature_args: Tuple[str, ...] = tuple()
+        if signatures is not None:
+            signatures_path = ir_path.with_suffix(".{}.signatures.json".format(str(uuid4())))
+            with open(signatures_path, mode="w") as f:
+                json.dump(signatures, f)
+            signature_args = ("--signatures", str(signatures_path))
+
+        check_call(
+            [
+                BUILD / "factgen-exe",
+                "--out-dir",
+                out_path,
+                "--compression",
+                "none",
+                *signature_args,
+                *args,
+                ir_path,
+            ]
+        )
+
+        assert out_path.exists()
+        return out_path
+
+    return _factgen
+
+
 _GOLD_DIR: Path = PARENT / "gold"
 
 
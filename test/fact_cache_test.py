@@ -0,0 +1,95 @@
+import re
+import shutil
+from pathlib import Path
+from typing import Dict, List, Tuple
+
+import pytest
+
+STATS = re.compile(r"Fact cache hits: (\d+) of (\d+) functions")
+
+
+def read_facts(facts: Path) -> Dict[str, List[str]]:
+    # Cached facts may be written in a different order
+    return {f.name: sorted(f.read_text().splitlines()) for f in facts.glob("*.csv")}
+
+
+def cache_stats(capfd) -> Tuple[int, int]:
+    match = STATS.search(capfd.readouterr().err)
+    assert match is not None
+    return int(match.group(1)), int(match.group(2))
+
+
+def copy_bitcode(bitcode, source: Path, destination: Path) -> Path:
+    # Cache keys include the path of the bitcode, so successive versions of a
+    # program must be compiled from, and to, the same paths
+    shutil.copy(bitcode(source), destination)
+    return destination
+
+
+def test_fact_cache_reuses_facts(bitcode, factgen, capfd, tmp_path):
+    program = copy_bitcode(bitcode, "hello.c", tmp_path / "hello.bc")
+    cache = str(tmp_path / "cache")
+    fresh = read_facts(factgen(program))
+
+    first = factgen(program, "--fact-cache", cache, "--print-stats")
+    hits, functions = cache_stats(capfd)
+    assert hits == 0
+    assert functions > 0
+
+    second = factgen(program, "--fact-cache", cache, "--print-stats")
+    assert cache_stats(capfd) == (functions, functions)
+
+    assert read_facts(first) == fresh
+    assert read_facts(second) == fresh
+
+
+def test_fact_cache_misses_changed_function(
+    bitcode, factgen, capfd, programs_path, tmp_path
+):
+    source = tmp_path / "src" / "hello.c"
+    source.parent.mkdir()
+    program = tmp_path / "hello.bc"
+    cache = str(tmp_path / "cache")
+
+    original = (programs_path / "hello.c").read_text()
+    source.write_text(original)
+    copy_bitcode(bitcode, source, program)
+    factgen(program, "--fact-cache", cache)
+
+    # Only change bar, keeping line numbers
+    changed = original.replace('printf("bar!\\n");', 'printf("baz!\\n");')
+    assert changed != original
+    source.write_text(changed)
+    copy_bitcode(bitcode, source, program)
+    capfd.readouterr()
+
+    facts = factgen(program, "--fact-cache", cache, "--print-stats")
+    hits, functions = cache_stats(capfd)
+    assert hits == functions - 1
+
+    assert read_facts(facts) == read_facts(factgen(program))
+
+
+@pytest.mark.parametrize("damage", ["corrupt", "truncate"])
+def test_fact_cache_rejects_damaged_entries(bitcode, factgen, capfd, tmp_path, damage):
+    program = copy_bitcode(bitcode, "hello.c", tmp_path / "hello.bc")
+    cache = tmp_path / "cache"
+    factgen(program, "--fact-cache", str(cache))
+
+    entries = [entry for entry in cache.rglob("*") if entry.is_file()]
+    assert len(entries) > 0
+    for entry in entries:
+        contents = bytearray(entry.read_bytes())
+        if damage == "corrupt":
+            contents[len(contents) // 2] ^= 0xFF
+        else:
+            del contents[len(contents) // 2 :]
+        entry.write_bytes(bytes(contents))
+    capfd.readouterr()
+
+    facts = factgen(program, "--fact-cache", str(cache), "--print-stats")
+    hits, functions = cache_stats(capfd)
+    assert hits == 0
+    assert functions > 0
+
+    assert read_facts(facts) == read_facts(factgen(program))
@@ -43,17 +43,29 @@ _PROGRAMS: Final[List[str]] = [
 _CFLAGS: Final[List[Tuple[str]]] = [("-O0",), ("-O1",)]
 _VARIANTS: Final[List[str]] = ["subset", "unification"]
 _SENSITIVITIES: Final[List[str]] = ["1-callsite", "2-callsite"]
-_INPUTS = list(product(_PROGRAMS, _CFLAGS, _SENSITIVITIES))
+# Ways of loading the facts, which must all give the same results
+_PASS_FLAGS: Final[List[Tuple[str, ...]]] = [
+    (),
+    ("-intern-fact-symbols",),
+    ("-in-memory-facts",),
+    ("-in-memory-facts", "-intern-fact-symbols"),
+]
+_INPUTS = list(product(_PROGRAMS, _CFLAGS, _SENSITIVITIES, _PASS_FLAGS))
 
 
-@pytest.mark.parametrize("program, cflags, sensitivity", _INPUTS)
-def test_pointer_analysis_golden(golden, run, program, cflags, sensitivity):
+@pytest.mark.parametrize("program, cflags, sensitivity, pass_flags", _INPUTS)
+def test_pointer_analysis_golden(golden, run, program, cflags, sensitivity, pass_flags):
     gold = golden(
         program, _GOLDEN_RELATIONS, context_sensitivity=sensitivity, additional_cflags=cflags
     )
     assert len(gold) == len(_GOLDEN_RELATIONS)  # sanity check
 
-    out_dir = run(program, context_sensitivity=sensitivity, additional_cflags=cflags)
+    out_dir = run(
+        program,
+        context_sensitivity=sensitivity,
+        pass_flags=pass_flags,
+        additional_cflags=cflags,
+    )
     for relation in _GOLDEN_RELATIONS:
         out_path = f"{out_dir / relation}.csv.gz"
 
@@ -68,8 +80,11 @@ def test_pointer_analysis_golden(golden, run, program, cflags, sensitivity):
 
         golden_file_name = str(gold[relation])
         assert golden_file_name.endswith(".golden.csv")
+        # Tests with different flags may run at the same time
         actual_file_name = (
-            golden_file_name[: len(golden_file_name) - len(".golden.csv")] + ".actual.csv"
+            golden_file_name[: len(golden_file_name) - len(".golden.csv")]
+            + "".join(pass_flags)
+            + ".actual.csv"
         )
 
         if os.path.exists(actual_file_name):
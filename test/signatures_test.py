@@ -1,5 +1,7 @@
 import gzip
 
+import pytest
+
 def test_pointer_analysis_string_signatures(run):
     # This is run at -O0 because the templated functions are inlined otherwise .
     no_signatures_dir = run("strings.cpp", additional_cflags=("-O0",))
@@ -16,3 +18,44 @@ def test_pointer_analysis_string_signatures(run):
             # The definitions of functions with signatures should be excluded
             # by the fact generator, resulting in fewer variables.
             assert len(f1.readlines()) > len(f2.readlines())
+
+
+@pytest.mark.parametrize(
+    "pattern,matches",
+    [
+        ("main", True),
+        # Escapes
+        (r"\x6dain", True),
+        (r"\u006dain", True),
+        (r"ma\x78in", False),
+        (r"mai\cJ?n", True),
+        (r"\w+ain", True),
+        (r"m\.?ain", True),
+        # Quantifiers
+        ("max?in", True),
+        ("max*in", True),
+        ("mx{0}ain", True),
+        ("ma+in", True),
+        ("max+in", False),
+        # Groups
+        ("m(a|x)in", True),
+        ("(ma)in", True),
+        (r"(m)\1?ain", True),
+        ("m(x)in", False),
+        # Alternation
+        ("foo|main", True),
+        ("main|foo", True),
+        ("baz|qux", False),
+        # Character classes
+        ("m[a-c]in", True),
+        ("m[(|]?ain", True),
+        ("m[x]in", False),
+    ],
+)
+def test_signature_patterns(factgen, pattern, matches):
+    # Function names are filtered by a literal that every match of a pattern
+    # contains, before trying the pattern itself. That must not drop matches.
+    facts = factgen("hello.c", signatures={pattern: [{"pts_none": []}]})
+    with open(facts / "signature_none.csv") as f:
+        functions = [line.rstrip("\n") for line in f]
+    assert ("@main" in functions) == matches